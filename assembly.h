@@ -1,15 +1,16 @@
-#ifndef ASSEMBLY_H_
-#define ASSEMBLY_H_
-
-#include "system_m.h"
-
-void _transfer();
-Process _createStack(unsigned int* newSP,unsigned int* newPC,int stackSize);
-
-
-#endif /*ASSEMBLY_H_*/
-
-
-
-
-
+#ifndef ASSEMBLY_H_
+#define ASSEMBLY_H_
+
+#include "system_m.h"
+
+void _transfer();
+Process _createStack(unsigned int* newSP,unsigned int* newPC,int stackSize);
+unsigned int interruptedPC();
+
+
+#endif /*ASSEMBLY_H_*/
+
+
+
+
+
@@ -0,0 +1,299 @@
+/*
+ * Throughput and latency benchmark of the monitor Buffer of kernelTest2.
+ *
+ * Runs MESSAGES messages through each topology, for each payload size:
+ * 1:1, N:1 and 1:N producers/consumers and pipelines of K stages, with
+ * up to MAX_PROC - 1 processes (one more process drives the runs). Each
+ * run prints one line:
+ *
+ *     topology procs payload msgs/s switches/msg p50(us) p99(us)
+ *
+ * Latency goes from the moment a message is produced until the last
+ * process consumes it. Switches include the two taken by each clock
+ * tick. Then it prints the cycles taken by an uncontended acquire and
+ * release of a monitor, a semaphore and a mutex. It needs no input, and
+ * runs the same on the board and in the host build (see host/hal_host.c).
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <system.h>
+#include "kernel_config.h"
+#include "system_m.h"
+#include "interrupt.h"
+#include "kernel2.h"
+
+#define WORKER_STACK_SIZE 16000
+#define MESSAGES 2000 /* per run */
+#define MAX_PAYLOAD 256
+#define LOCK_PAIRS 100000 /* per primitive */
+
+#define WORKERS (MAX_PROC - 1)
+#define BUFFERS (WORKERS - 1) /* a pipeline of WORKERS stages */
+
+#if WORKERS < 2 || BUFFERS > MAX_MONITORS || MAX_SEMAPHORES < 3 || MAX_MUTEXES < 1
+#error "the benchmark needs at least 3 processes, 3 semaphores, a mutex and a monitor per buffer"
+#endif
+
+static const int payloads[] = {4, 64, MAX_PAYLOAD};
+#define PAYLOADS (sizeof(payloads) / sizeof(payloads[0]))
+
+/*********************** Buffer implemented using monitors *********************/
+typedef struct {
+    char payload[MAX_PAYLOAD];
+    int size;
+    unsigned int sent; /* timestamp of the producer */
+    int full;
+    int monitor;
+} Buffer;
+
+void initBuffer(Buffer* b) {
+    b->monitor = createMonitor();
+    b->full = 0;
+}
+
+void put(Buffer* b, const char* payload, int size, unsigned int sent) {
+    enterMonitor(b->monitor);
+    while(b->full) {
+        wait();
+    }
+    memcpy(b->payload, payload, size);
+    b->size = size;
+    b->sent = sent;
+    b->full = 1;
+    notify();
+    exitMonitor();
+}
+
+unsigned int get(Buffer* b, char* payload) {
+    unsigned int sent;
+
+    enterMonitor(b->monitor);
+    while (!b->full) {
+        wait();
+    }
+    memcpy(payload, b->payload, b->size);
+    sent = b->sent;
+    b->full = 0;
+    notifyAll();
+    exitMonitor();
+
+    return sent;
+}
+/*****************************************************************************/
+
+/* What a worker does in a run: producers have no input buffer, consumers
+ * no output buffer */
+typedef struct {
+    Buffer* in;
+    Buffer* out;
+    int messages;
+} Role;
+
+Buffer buffers[BUFFERS];
+
+static Role roles[WORKERS];
+static int roleCount = 0;
+static int nextRole = 0;
+static int payloadSize;
+
+/* workers wait on startRun for a role, and post runDone when it is over */
+static int startRun, runDone;
+
+/* only taken by the controller, to time the primitives uncontended */
+static int lockSemaphore, lockMutex;
+
+static unsigned int latencies[MESSAGES];
+static int latencyCount = 0;
+
+void worker() {
+    char payload[MAX_PAYLOAD];
+    int i;
+
+    while (1) {
+        semWait(startRun);
+
+        irqState state = kernelLock();
+        Role* role = &roles[nextRole++];
+        kernelUnlock(state);
+
+        for (i = 0; i < role->messages; i++) {
+            unsigned int sent;
+
+            if (role->in != NULL) {
+                sent = get(role->in, payload);
+            }
+            else {
+                memset(payload, i, payloadSize);
+                sent = timestamp();
+            }
+
+            if (role->out != NULL) {
+                put(role->out, payload, payloadSize, sent);
+            }
+            else {
+                unsigned int latency = timestamp() - sent;
+                state = kernelLock();
+                if (latencyCount < MESSAGES) {
+                    latencies[latencyCount++] = latency;
+                }
+                kernelUnlock(state);
+            }
+        }
+        semPost(runDone);
+    }
+}
+
+static void addRole(Buffer* in, Buffer* out, int messages) {
+    roles[roleCount].in = in;
+    roles[roleCount].out = out;
+    roles[roleCount].messages = messages;
+    roleCount++;
+}
+
+static int compareLatencies(const void* a, const void* b) {
+    unsigned int x = *(const unsigned int*) a;
+    unsigned int y = *(const unsigned int*) b;
+    return x < y ? -1 : x > y;
+}
+
+/* prints cycles in microseconds, with one decimal */
+static void printMicroseconds(unsigned int cycles) {
+    unsigned int tenths = (unsigned long long) cycles * 10 / (TIMER_1_FREQ / 1000000);
+    printf(" %7u.%u", tenths / 10, tenths % 10);
+}
+
+/* runs the roles added since the last run, then prints their results */
+static void run(const char* topology, int messages) {
+    int i;
+
+    nextRole = 0;
+    latencyCount = 0;
+
+    unsigned int switches = switchCount();
+    unsigned int begin = timestamp();
+
+    for (i = 0; i < roleCount; i++) {
+        semPost(startRun);
+    }
+    for (i = 0; i < roleCount; i++) {
+        semWait(runDone);
+    }
+
+    unsigned int cycles = timestamp() - begin;
+    switches = switchCount() - switches;
+
+    qsort(latencies, latencyCount, sizeof(latencies[0]), compareLatencies);
+
+    unsigned int rate = (unsigned long long) messages * TIMER_1_FREQ / (cycles ? cycles : 1);
+    unsigned int switchesPerMessage = switches * 100 / messages;
+    printf("%-8s %5d %7d %9u %5u.%02u", topology, roleCount, payloadSize, rate,
+           switchesPerMessage / 100, switchesPerMessage % 100);
+    printMicroseconds(latencies[latencyCount / 2]);
+    printMicroseconds(latencies[latencyCount * 99 / 100]);
+    printf("\n");
+
+    roleCount = 0;
+}
+
+/* prints the cycles per pair, with one decimal, since begin */
+static void printPairCycles(const char* primitive, unsigned int begin) {
+    unsigned int tenths = (unsigned long long) (timestamp() - begin) * 10 / LOCK_PAIRS;
+    printf("%-9s %7u.%u\n", primitive, tenths / 10, tenths % 10);
+}
+
+/* the workers are blocked on startRun, so nothing contends */
+static void timeLocks() {
+    unsigned int begin;
+    int i;
+
+    printf("primitive cycles/pair\n");
+
+    begin = timestamp();
+    for (i = 0; i < LOCK_PAIRS; i++) {
+        enterMonitor(buffers[0].monitor);
+        exitMonitor();
+    }
+    printPairCycles("monitor", begin);
+
+    begin = timestamp();
+    for (i = 0; i < LOCK_PAIRS; i++) {
+        semWait(lockSemaphore);
+        semPost(lockSemaphore);
+    }
+    printPairCycles("semaphore", begin);
+
+    begin = timestamp();
+    for (i = 0; i < LOCK_PAIRS; i++) {
+        mutexLock(lockMutex);
+        mutexUnlock(lockMutex);
+    }
+    printPairCycles("mutex", begin);
+}
+
+void controller() {
+    size_t p;
+    int n, i;
+
+    printf("topology procs payload    msgs/s switches/msg p50(us)  p99(us)\n");
+
+    for (p = 0; p < PAYLOADS; p++) {
+        payloadSize = payloads[p];
+
+        addRole(NULL, &buffers[0], MESSAGES);
+        addRole(&buffers[0], NULL, MESSAGES);
+        run("1:1", MESSAGES);
+
+        for (n = 2; n < WORKERS; n++) {
+            int each = MESSAGES / n;
+            for (i = 0; i < n; i++) {
+                addRole(NULL, &buffers[0], each);
+            }
+            addRole(&buffers[0], NULL, each * n);
+            run("N:1", each * n);
+        }
+
+        for (n = 2; n < WORKERS; n++) {
+            int each = MESSAGES / n;
+            addRole(NULL, &buffers[0], each * n);
+            for (i = 0; i < n; i++) {
+                addRole(&buffers[0], NULL, each);
+            }
+            run("1:N", each * n);
+        }
+
+        for (n = 3; n <= WORKERS; n++) {
+            addRole(NULL, &buffers[0], MESSAGES);
+            for (i = 1; i < n - 1; i++) {
+                addRole(&buffers[i - 1], &buffers[i], MESSAGES);
+            }
+            addRole(&buffers[n - 2], NULL, MESSAGES);
+            run("pipeline", MESSAGES);
+        }
+    }
+
+    timeLocks();
+
+    printf("done\n");
+    exit(0);
+}
+
+int main() {
+    int i;
+
+    for (i = 0; i < BUFFERS; i++) {
+        initBuffer(&buffers[i]);
+    }
+    startRun = createSemaphore(0);
+    runDone = createSemaphore(0);
+    lockSemaphore = createSemaphore(1);
+    lockMutex = createMutex();
+
+    createProcess(controller, WORKER_STACK_SIZE);
+    for (i = 0; i < WORKERS; i++) {
+        createProcess(worker, WORKER_STACK_SIZE);
+    }
+
+    start();
+    return 0;
+}
@@ -0,0 +1,102 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <system.h>
+#include <altera_avalon_pio_regs.h>
+
+#include "kernel_config.h"
+#include "interrupt.h"
+#include "kernel2.h"
+#include "display.h"
+
+/* LCD representations of the digits, and of DISPLAY_BLANK */
+static const int digitCodes[] = {0x3E223E00, 0x203E2400, 0x2E2A3A00, 0x3E2A2A00, 0x3E080E00,
+                                 0x3A2A2E00, 0x3A2A3E00, 0x3E020200, 0x3E2A3E00, 0x3E2A2E00, 0};
+
+static const int zoneBases[DISPLAY_ZONES] = {LED_0_BASE, LED_1_BASE, LED_2_BASE, LED_COLOR_BASE};
+
+/* What clients asked for, and what the PIOs show */
+static volatile int shadow[DISPLAY_ZONES];
+static int written[DISPLAY_ZONES];
+static int writtenValid = 0;
+
+/* Half blink periods left per zone; the zone is dark while it is odd */
+static int blinkPhases[DISPLAY_ZONES];
+
+static void checkZone(int zone)
+{
+    if(zone < 0 || zone >= DISPLAY_ZONES){
+        fprintf(stderr, "Error: display zone %d does not exist.\n", zone);
+        exit(1);
+    }
+}
+
+/* write the zones that changed since the last refresh */
+static void flushZones()
+{
+    int zone;
+
+    for(zone = 0; zone < DISPLAY_ZONES; zone++){
+        int value = (blinkPhases[zone] & 1) ? 0 : shadow[zone];
+        if(!writtenValid || value != written[zone]){
+            IOWR_ALTERA_AVALON_PIO_DATA(zoneBases[zone], value);
+            written[zone] = value;
+        }
+    }
+    writtenValid = 1;
+}
+
+/* timer callback: advance the blinks, then flush */
+static void refreshDisplay(void* arg)
+{
+    static int ticks = 0;
+    int zone;
+
+    ticks += DISPLAY_REFRESH_TICKS;
+    if(ticks >= DISPLAY_BLINK_TICKS){
+        ticks = 0;
+        for(zone = 0; zone < DISPLAY_ZONES; zone++){
+            if(blinkPhases[zone] > 0){
+                blinkPhases[zone]--;
+            }
+        }
+    }
+
+    flushZones();
+}
+
+void initDisplay()
+{
+    startTimer(createTimer(refreshDisplay, NULL, DISPLAY_REFRESH_TICKS, 1));
+}
+
+void displaySet(int zone, int value)
+{
+    checkZone(zone);
+    shadow[zone] = value;
+}
+
+void displayDigit(int zone, int digit)
+{
+    if(zone == DISPLAY_COLOR || digit < 0 || digit > DISPLAY_BLANK){
+        fprintf(stderr, "Error: cannot show digit %d in zone %d.\n", digit, zone);
+        exit(1);
+    }
+    displaySet(zone, digitCodes[digit]);
+}
+
+void displayFlush()
+{
+    irqState state = kernelLock();
+    flushZones();
+    kernelUnlock(state);
+}
+
+void displayBlink(int zone, int times)
+{
+    checkZone(zone);
+
+    irqState state = kernelLock();
+    /* go dark first; times dark halves separated by lit ones */
+    blinkPhases[zone] = times > 0 ? 2 * times - 1 : 0;
+    kernelUnlock(state);
+}
@@ -0,0 +1,31 @@
+#ifndef DISPLAY_H_
+#define DISPLAY_H_
+
+/* Zones of the display: the three digits LED_0 to LED_2, and LED_color. */
+#define DISPLAY_ZONES 4
+#define DISPLAY_COLOR 3
+
+/* Digit value that turns a digit zone off. */
+#define DISPLAY_BLANK 10
+
+/* Function that starts the display driver, a periodic kernel timer that
+ * writes the zones whose content changed to the PIOs. Call it before
+ * start(). */
+void initDisplay();
+
+/* Function that sets the raw PIO value of a zone. It only updates the
+ * shadow copy, so it never blocks; the driver writes it out at its next
+ * refresh. */
+void displaySet(int zone, int value);
+
+/* Function that shows digit 0-9, or DISPLAY_BLANK, in a digit zone. */
+void displayDigit(int zone, int digit);
+
+/* Function that writes the pending changes out now, e.g. before exiting. */
+void displayFlush();
+
+/* Function that makes a zone blink the given number of times, whatever
+ * it shows meanwhile. */
+void displayBlink(int zone, int times);
+
+#endif /*DISPLAY_H_*/
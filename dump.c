@@ -0,0 +1,159 @@
+#include <stdio.h>
+#include <system.h>
+#include <altera_avalon_pio_regs.h>
+#include <altera_avalon_jtag_uart_regs.h>
+
+#include "kernel_config.h"
+#include "interrupt.h"
+#include "kernel2.h"
+#include "dump.h"
+
+static unsigned int dumpStack[DUMP_STACK_SIZE / sizeof(unsigned int)];
+
+/* Too large for the stack of the dump process */
+static KernelSnapshot snapshot;
+
+static int requests = -1;
+static int switches;
+
+static int readSwitches()
+{
+    return IORD_ALTERA_AVALON_PIO_DATA(SWITCH_0_BASE)
+        | IORD_ALTERA_AVALON_PIO_DATA(SWITCH_1_BASE) << INPUT_SWITCH_BITS;
+}
+
+/* timer callback, run by the clock with interrupts masked */
+static void pollRequests(void* arg)
+{
+    int now = readSwitches();
+
+    /* consume a single trigger byte per poll; the rest stays queued */
+    int received = IORD_ALTERA_AVALON_JTAG_UART_DATA(JTAG_UART_0_BASE) & ALTERA_AVALON_JTAG_UART_DATA_RVALID_MSK;
+
+    if(now != switches || received){
+        switches = now;
+        requestDump();
+    }
+}
+
+/* prints the queue starting at pid, with the ticks left if timed */
+static void printQueue(int pid, int timed)
+{
+    int length = 0;
+
+    if(pid == -1){
+        printf(" -");
+    }
+    /* the copy is consistent, but do not trust it to end */
+    while(pid >= 0 && pid < snapshot.processCount && length++ < snapshot.processCount){
+        if(timed && snapshot.processes[pid].timeLeft > 0){
+            printf(" %d/%d", pid, snapshot.processes[pid].timeLeft);
+        }
+        else{
+            printf(" %d", pid);
+        }
+        pid = snapshot.processes[pid].next;
+    }
+}
+
+static void printDump()
+{
+    int i, pid;
+
+    printf("dump begin tick=%u\n", snapshot.ticks);
+    printf("ready:");
+    printQueue(snapshot.readyList, 0);
+    printf("\nsleeping:");
+    printQueue(snapshot.sleepingList, 1);
+    printf("\n");
+
+    for(i = 0; i < snapshot.monitorCount; i++){
+        /* a free monitor with processes waiting to enter is a stall,
+         * so every queue counts */
+        if(snapshot.monitors[i].takenBy == -1 && snapshot.monitors[i].readers == 0
+           && snapshot.monitors[i].entryList == -1 && snapshot.monitors[i].waitingList == -1
+           && snapshot.monitors[i].timedWaitList == -1 && snapshot.monitors[i].sharedList == -1){
+            continue;
+        }
+        printf("monitor %d: owner=%dx%d readers=%d", i, snapshot.monitors[i].takenBy,
+               snapshot.monitors[i].timesTaken, snapshot.monitors[i].readers);
+        printf(" entry:");
+        printQueue(snapshot.monitors[i].entryList, 0);
+        printf(" waiting:");
+        printQueue(snapshot.monitors[i].waitingList, 0);
+        printf(" timed:");
+        printQueue(snapshot.monitors[i].timedWaitList, 1);
+        printf(" shared:");
+        printQueue(snapshot.monitors[i].sharedList, 0);
+        printf("\n");
+    }
+
+    for(i = 0; i < snapshot.channelCount; i++){
+        if(snapshot.channels[i].receiveList == -1 && snapshot.channels[i].sendList == -1){
+            continue;
+        }
+        printf("channel %d: count=%d", i, snapshot.channels[i].count);
+        printf(" receive:");
+        printQueue(snapshot.channels[i].receiveList, 0);
+        printf(" send:");
+        printQueue(snapshot.channels[i].sendList, 0);
+        printf("\n");
+    }
+
+    for(i = 0; i < snapshot.semaphoreCount; i++){
+        if(snapshot.semaphores[i].waitList == -1){
+            continue;
+        }
+        printf("semaphore %d: count=%d", i, snapshot.semaphores[i].count);
+        printf(" waiting:");
+        printQueue(snapshot.semaphores[i].waitList, 1);
+        printf("\n");
+    }
+
+    for(i = 0; i < snapshot.mutexCount; i++){
+        if(snapshot.mutexes[i].owner == -1 && snapshot.mutexes[i].waitList == -1){
+            continue;
+        }
+        printf("mutex %d: owner=%d", i, snapshot.mutexes[i].owner);
+        printf(" waiting:");
+        printQueue(snapshot.mutexes[i].waitList, 0);
+        printf("\n");
+    }
+
+    /* interrupt 0 is only waited for by the clock process */
+    for(i = 1; i < INTERRUPT_COUNT; i++){
+        printf("interrupt %d:", i);
+        for(pid = 0; pid < snapshot.processCount; pid++){
+            if(snapshot.processes[pid].interrupt == i){
+                printf(" %d", pid);
+            }
+        }
+        printf("\n");
+    }
+    printf("dump end\n");
+}
+
+static void dumpProcess()
+{
+    while(1){
+        semWait(requests);
+        /* requests made meanwhile are answered by this dump */
+        while(semTryWait(requests)){
+        }
+        kernelSnapshot(&snapshot);
+        printDump();
+    }
+}
+
+void requestDump()
+{
+    semPost(requests);
+}
+
+void initDump()
+{
+    switches = readSwitches();
+    requests = createSemaphore(0);
+    createStaticProcess(dumpProcess, dumpStack, sizeof(dumpStack));
+    startTimer(createTimer(pollRequests, NULL, DUMP_POLL_TICKS, 1));
+}
@@ -0,0 +1,29 @@
+#ifndef DUMP_H_
+#define DUMP_H_
+
+/* Function that starts the kernel dump: every DUMP_POLL_TICKS ticks a
+ * kernel timer checks SWITCH_0, SWITCH_1 and the JTAG UART, and any
+ * change of a switch or byte received makes a process snapshot the
+ * kernel tables (see kernelSnapshot) and write them to the JTAG UART:
+ *
+ *     dump begin tick=1234
+ *     ready: 3 0 5
+ *     sleeping: 2/4 7/11
+ *     monitor 0: owner=4x1 readers=0 entry: 5 6 waiting: - timed: 8/2 shared: -
+ *     semaphore 1: count=0 waiting: 9
+ *     interrupt 1: 1
+ *     dump end
+ *
+ * Processes are given by their number, followed by /ticks left when they
+ * wait with a timeout. The process writing the dump is first in the ready
+ * list. Objects that are free and that nobody waits for are left out.
+ * The dump process runs on a static stack and takes one of the MAX_PROC
+ * processes. Every byte received on the JTAG UART is taken as a request,
+ * one per poll, so do not use the dump with another reader of the UART.
+ * Call it before start(). */
+void initDump();
+
+/* Function that requests a dump, as a switch change would. */
+void requestDump();
+
+#endif /*DUMP_H_*/
@@ -0,0 +1,261 @@
+/*
+ * Model of the board for the host build: the interrupt switch of asm.s,
+ * alt_irq_register, and the registers of the PIOs, of both timers and of
+ * the JTAG UART.
+ *
+ * Time is taken from the host's monotonic clock and counted in cycles of
+ * a 50 MHz processor. The timer interrupts every 1/TICKS_PER_SECOND
+ * second once init_clock has started it, and timer_1 counts down for
+ * timestamp(). The JTAG UART writes to standard output.
+ *
+ * Interrupts are only taken where the kernel lets them in: when
+ * allowInterrupts, kernelUnlock or transfer turn the interrupt switch
+ * back on. A process that loops without calling the kernel is never
+ * preempted.
+ *
+ * After hostSimulate, time is simulated instead (see hal_host.h): each
+ * of these interrupt points is a step of HOST_STEP_CYCLES cycles, and
+ * interrupts only come from hostTick and hostPressButtons, so that a run
+ * only depends on when they are called.
+ *
+ * Build a program with the kernel sources, except system_m.c and asm.s:
+ *
+ *     gcc -std=gnu99 -O2 -Ihost/include -I. -o benchmark benchmark.c \
+ *         kernel2.c interrupt.c pool.c log.c \
+ *         host/system_m_host.c host/hal_host.c
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <system.h>
+#include <sys/alt_irq.h>
+#include <altera_avalon_timer_regs.h>
+#include <altera_avalon_jtag_uart_regs.h>
+#include "host_io.h"
+#include "hal_host.h"
+#include "kernel_config.h"
+#include "interrupt.h"
+
+#define HOST_IRQS 32
+#define HOST_PIO_REGS 4
+#define TICK_CYCLES (ALT_CPU_FREQ / TICKS_PER_SECOND)
+
+typedef struct {
+    void* context;
+    void (*handler)(void*, alt_u32);
+} HostIrq;
+
+static HostIrq irqs[HOST_IRQS];
+
+/* Interrupt switch: bit 0 of the status register */
+static unsigned int status = 1;
+
+static const unsigned int pioBases[] = {BUTTONS_BASE, LED_0_BASE, LED_1_BASE, LED_2_BASE,
+                                        LED_COLOR_BASE, SWITCH_0_BASE, SWITCH_1_BASE};
+#define HOST_PIOS (sizeof(pioBases) / sizeof(pioBases[0]))
+
+/* the buttons read 1 while released */
+static unsigned int pioRegs[HOST_PIOS][HOST_PIO_REGS] = {{0xf}};
+
+/* Timer: control register, timeout flag and cycle of the next timeout */
+static unsigned int timerControl = 0;
+static unsigned int timerTimeout = 0;
+static unsigned long long nextTick = 0;
+
+/* timer_1: count latched by the last snapshot */
+static unsigned int snapshot = 0;
+
+/* Simulated time: hook called at each step, and steps so far */
+static void (*stepHook)(unsigned long long step) = NULL;
+static unsigned long long steps = 0;
+
+static unsigned long long cycles()
+{
+    static struct timespec boot;
+    struct timespec now;
+
+    if(stepHook != NULL){
+        return steps * HOST_STEP_CYCLES;
+    }
+
+    if(boot.tv_sec == 0 && boot.tv_nsec == 0){
+        clock_gettime(CLOCK_MONOTONIC, &boot);
+    }
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return ((unsigned long long) (now.tv_sec - boot.tv_sec) * 1000000000ull
+            + now.tv_nsec - boot.tv_nsec) / (1000000000ull / ALT_CPU_FREQ);
+}
+
+static unsigned int* pio(unsigned int base, int reg)
+{
+    int i;
+
+    for(i = 0; i < HOST_PIOS; i++){
+        if(pioBases[i] == base && reg >= 0 && reg < HOST_PIO_REGS){
+            return &pioRegs[i][reg];
+        }
+    }
+    fprintf(stderr, "Error: no register %d at 0x%x in the host build.\n", reg, base);
+    exit(1);
+}
+
+unsigned int hostRead(unsigned int base, int reg)
+{
+    switch(base){
+    case TIMER_BASE:
+        return reg == 0 ? timerTimeout : reg == 1 ? timerControl : 0;
+    case TIMER_1_BASE:
+        return reg == 4 ? snapshot & 0xffff : reg == 5 ? snapshot >> 16 : 0;
+    case JTAG_UART_0_BASE:
+        /* nothing to read; always room to write */
+        return reg == 1 ? ALTERA_AVALON_JTAG_UART_CONTROL_WSPACE_MSK : 0;
+    default:
+        return *pio(base, reg);
+    }
+}
+
+void hostWrite(unsigned int base, int reg, unsigned int value)
+{
+    switch(base){
+    case TIMER_BASE:
+        if(reg == 0){
+            timerTimeout = 0;
+        }
+        else if(reg == 1){
+            timerControl = value;
+            nextTick = cycles() + TICK_CYCLES;
+        }
+        break;
+    case TIMER_1_BASE:
+        /* free running from the largest period, as set by init_timestamp */
+        if(reg == 4){
+            snapshot = 0xffffffffu - (unsigned int) cycles();
+        }
+        break;
+    case JTAG_UART_0_BASE:
+        if(reg == 0){
+            putchar(value & ALTERA_AVALON_JTAG_UART_DATA_DATA_MSK);
+        }
+        break;
+    default:
+        if(reg == 3){
+            /* writing edge capture bits clears them */
+            *pio(base, reg) &= ~value;
+        }
+        else{
+            *pio(base, reg) = value;
+        }
+        break;
+    }
+}
+
+/* the highest priority interrupt pending, or -1 */
+static int pendingIrq()
+{
+    if(stepHook == NULL && (timerControl & ALTERA_AVALON_TIMER_CONTROL_START_MSK)
+       && cycles() >= nextTick){
+        /* like the hardware, ticks missed meanwhile raise a single timeout */
+        timerTimeout = ALTERA_AVALON_TIMER_STATUS_TO_MSK;
+        nextTick = cycles() + TICK_CYCLES;
+    }
+    if(timerTimeout && (timerControl & ALTERA_AVALON_TIMER_CONTROL_ITO_MSK)){
+        return TIMER_IRQ;
+    }
+    if(*pio(BUTTONS_BASE, 3) & *pio(BUTTONS_BASE, 2)){
+        return BUTTONS_IRQ;
+    }
+    return -1;
+}
+
+/* take the pending interrupts, as the processor does as soon as the
+ * interrupt switch is on */
+static void interruptPoint()
+{
+    int irq;
+
+    if((status & 1) && stepHook != NULL){
+        /* the hook runs masked, so that it may call the kernel */
+        status = 0;
+        stepHook(++steps);
+        status = 1;
+    }
+
+    while((status & 1) && (irq = pendingIrq()) >= 0 && irqs[irq].handler != NULL){
+        status = 0;
+        irqs[irq].handler(irqs[irq].context, irq);
+        status = 1;
+    }
+}
+
+int alt_irq_register(alt_u32 id, void* context, void (*handler)(void*, alt_u32))
+{
+    if(id >= HOST_IRQS){
+        return -1;
+    }
+    irqs[id].context = context;
+    irqs[id].handler = handler;
+    return 0;
+}
+
+void hostSimulate(void (*hook)(unsigned long long step))
+{
+    stepHook = hook;
+}
+
+void hostTick()
+{
+    if(timerControl & ALTERA_AVALON_TIMER_CONTROL_START_MSK){
+        timerTimeout = ALTERA_AVALON_TIMER_STATUS_TO_MSK;
+    }
+}
+
+void hostPressButtons(unsigned int buttons)
+{
+    /* the buttons read 0 while pressed; the PIO captures falling edges */
+    *pio(BUTTONS_BASE, 0) &= ~buttons;
+    *pio(BUTTONS_BASE, 3) |= buttons;
+}
+
+void hostReleaseButtons(unsigned int buttons)
+{
+    *pio(BUTTONS_BASE, 0) |= buttons;
+}
+
+void LedInit()
+{
+}
+
+void maskInterrupts()
+{
+    status = 0;
+}
+
+void allowInterrupts()
+{
+    status = 1;
+    interruptPoint();
+}
+
+int interruptsEnabled()
+{
+    return status & 1;
+}
+
+irqState (kernelLock)()
+{
+    irqState state = status;
+    status = 0;
+    return state;
+}
+
+void (kernelUnlock)(irqState state)
+{
+    status = state;
+    interruptPoint();
+}
+
+unsigned int interruptedPC()
+{
+    return 0;
+}
@@ -0,0 +1,21 @@
+#ifndef HAL_HOST_H_
+#define HAL_HOST_H_
+
+/* Cycles of simulated time per step */
+#define HOST_STEP_CYCLES 50
+
+/* Function that switches the host build to simulated time. hook is then
+ * called at every step, with interrupts masked, before the pending
+ * interrupts are taken; it is where interrupts are raised. Call it
+ * before start(). */
+void hostSimulate(void (*hook)(unsigned long long step));
+
+/* Function that raises a clock tick, taken once the step is over. */
+void hostTick();
+
+/* Functions that press and release buttons, given as a bit mask; a press
+ * raises the button interrupt. */
+void hostPressButtons(unsigned int buttons);
+void hostReleaseButtons(unsigned int buttons);
+
+#endif /*HAL_HOST_H_*/
@@ -0,0 +1,366 @@
+/*
+ * Stress test of the scheduler in simulated time, for the host build.
+ *
+ * Ten processes sleep, pass messages through a monitor with timed waits,
+ * wait on a semaphore with a timeout, fight for a mutex and wait for the
+ * buttons, while clock ticks and button presses are injected at
+ * pseudo-random steps (see hal_host.h). After every step the kernel
+ * tables are checked with checkKernel, and the processes check what they
+ * observe: sleeps that end early, lost or repeated messages, two owners
+ * of the mutex. The first failure stops the run.
+ *
+ * Usage: harness [-s seed] [-n steps] [-t tick steps] [-r record] [-p replay]
+ *
+ * -t sets the mean number of steps between two clock ticks (4). With the
+ * checks a run simulates about 750 ticks per millisecond on a desktop
+ * machine, and about 2200 with -t 1, where a tick can fall at every step;
+ * nearly all of that time goes to checkKernel. -r writes the injected events to a file, and -p injects those of a
+ * file instead of random ones, so that a failing run can be replayed
+ * exactly, e.g. in a debugger. Build it with the kernel checks:
+ *
+ *     gcc -std=gnu99 -O2 -DKERNEL_CHECKS -Ihost/include -I. -o harness \
+ *         host/harness.c kernel2.c interrupt.c pool.c log.c \
+ *         host/system_m_host.c host/hal_host.c
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "kernel_config.h"
+#include "interrupt.h"
+#include "kernel2.h"
+#include "hal_host.h"
+
+/* Mean number of steps between injected events, -t changes the first */
+#define TICK_STEPS 4
+#define PRESS_STEPS 5000
+#define RELEASE_STEPS 500
+
+#define SLEEPERS 3
+
+#if MAX_PROC < SLEEPERS + 7
+#error "the harness runs 10 processes"
+#endif
+
+static const int sleepTicks[SLEEPERS] = {2, 5, 11};
+
+/* Run parameters */
+static unsigned int seed = 1;
+static unsigned long long lastStep = 1000000;
+static unsigned int tickSteps = TICK_STEPS;
+static FILE* record = NULL;
+static FILE* replay = NULL;
+
+/* Next event to replay */
+static unsigned long long replayStep = 0;
+static char replayEvent[16];
+static unsigned int replayButtons = 0;
+
+static unsigned long long currentStep = 0;
+static unsigned int injectedTicks = 0;
+static unsigned int injectedPresses = 0;
+
+/* What the processes did */
+static unsigned int slept[SLEEPERS];
+static unsigned int sent = 0, received = 0, receiveTimeouts = 0;
+static unsigned int posted = 0, taken = 0, takeTimeouts = 0;
+static unsigned int locked = 0;
+static unsigned int interrupts = 0;
+
+static int monitor, semaphore, mutex;
+static int sleeperCount = 0;
+static int mutexOwners = 0;
+
+/* the one-slot buffer of kernelTest2 */
+static int message;
+static int full = 0;
+
+static void fail(const char* format, unsigned int a, unsigned int b)
+{
+    fprintf(stderr, "harness: step %llu: ", currentStep);
+    fprintf(stderr, format, a, b);
+    fprintf(stderr, "\n");
+    exit(1);
+}
+
+static unsigned int randomNumber()
+{
+    /* xorshift, so that runs do not depend on the C library */
+    seed ^= seed << 13;
+    seed ^= seed >> 17;
+    seed ^= seed << 5;
+    return seed;
+}
+
+static FILE* openFile(const char* name, const char* mode)
+{
+    FILE* file = fopen(name, mode);
+    if(file == NULL){
+        perror(name);
+        exit(2);
+    }
+    return file;
+}
+
+static void inject(const char* event, unsigned int buttons)
+{
+    if(strcmp(event, "tick") == 0){
+        hostTick();
+        injectedTicks++;
+    }
+    else if(strcmp(event, "press") == 0){
+        hostPressButtons(buttons);
+        injectedPresses++;
+    }
+    else if(strcmp(event, "release") == 0){
+        hostReleaseButtons(buttons);
+    }
+    else{
+        fail("unknown event in the replayed file", 0, 0);
+    }
+
+    if(record != NULL){
+        fprintf(record, "%llu %s %x\n", currentStep, event, buttons);
+    }
+}
+
+static void readReplayEvent()
+{
+    char line[64];
+
+    replayStep = 0;
+    while(fgets(line, sizeof(line), replay) != NULL){
+        if(line[0] != '#' && sscanf(line, "%llu %15s %x", &replayStep, replayEvent, &replayButtons) == 3){
+            return;
+        }
+    }
+}
+
+static void finish()
+{
+    int i;
+
+    for(i = 0; i < SLEEPERS; i++){
+        printf("sleeper %d: %u sleeps of %d ticks\n", i, slept[i], sleepTicks[i]);
+    }
+    printf("buffer: %u sent, %u received, %u timeouts\n", sent, received, receiveTimeouts);
+    printf("semaphore: %u posted, %u taken, %u timeouts\n", posted, taken, takeTimeouts);
+    printf("mutex: %u locks\n", locked);
+    printf("buttons: %u presses, %u interrupts\n", injectedPresses, interrupts);
+    printf("%llu steps, %u ticks, clock at %u\n", currentStep, injectedTicks, getTicks());
+
+    /* every process must have been able to run */
+    for(i = 0; i < SLEEPERS; i++){
+        if(injectedTicks > 100 && slept[i] == 0){
+            fail("sleeper %u never woke up", i, 0);
+        }
+    }
+    if(injectedTicks > 100 && (received == 0 || taken == 0 || locked == 0)){
+        fail("a process never made progress", 0, 0);
+    }
+    if(injectedPresses > 0 && interrupts == 0){
+        fail("%u presses were never delivered", injectedPresses, 0);
+    }
+    printf("ok\n");
+    exit(0);
+}
+
+/* called at every step, with interrupts masked */
+static void step(unsigned long long n)
+{
+    currentStep = n;
+
+    if(checkKernel() != 0){
+        fail("inconsistent kernel", 0, 0);
+    }
+
+    if(replay != NULL){
+        while(replayStep == n){
+            inject(replayEvent, replayButtons);
+            readReplayEvent();
+        }
+    }
+    else{
+        if(randomNumber() % tickSteps == 0){
+            inject("tick", 0);
+        }
+        if(randomNumber() % PRESS_STEPS == 0){
+            inject("press", 1 + randomNumber() % 15);
+        }
+        if(randomNumber() % RELEASE_STEPS == 0){
+            inject("release", 0xf);
+        }
+    }
+
+    if(n >= lastStep){
+        finish();
+    }
+}
+
+static int claim(int* counter)
+{
+    irqState state = kernelLock();
+    int id = (*counter)++;
+    kernelUnlock(state);
+    return id;
+}
+
+void sleeper()
+{
+    int id = claim(&sleeperCount);
+
+    while(1){
+        unsigned int before = getTicks();
+        sleep(sleepTicks[id]);
+        if(getTicks() - before < sleepTicks[id]){
+            fail("sleep(%u) returned after %u ticks", sleepTicks[id], getTicks() - before);
+        }
+        slept[id]++;
+    }
+}
+
+void producer()
+{
+    while(1){
+        enterMonitor(monitor);
+        while(full){
+            wait();
+        }
+        message = ++sent;
+        full = 1;
+        notify();
+        exitMonitor();
+
+        if(sent % 4 == 0){
+            sleep(1 + sent % 7);
+        }
+    }
+}
+
+void consumer()
+{
+    while(1){
+        enterMonitor(monitor);
+        if(!full){
+            timedWait(3);
+        }
+        if(full){
+            if(message != received + 1){
+                fail("received message %u after %u", message, received);
+            }
+            received = message;
+            full = 0;
+            notifyAll();
+        }
+        else{
+            receiveTimeouts++;
+        }
+        exitMonitor();
+    }
+}
+
+void poster()
+{
+    while(1){
+        sleep(3);
+        posted++;
+        semPost(semaphore);
+    }
+}
+
+void taker()
+{
+    while(1){
+        if(semTimedWait(semaphore, 4)){
+            if(++taken > posted){
+                fail("took %u units of %u posted", taken, posted);
+            }
+        }
+        else{
+            takeTimeouts++;
+        }
+    }
+}
+
+void locker()
+{
+    while(1){
+        mutexLock(mutex);
+        if(++mutexOwners != 1){
+            fail("%u owners of the mutex", mutexOwners, 0);
+        }
+        yield();
+        mutexOwners--;
+        locked++;
+        mutexUnlock(mutex);
+        yield();
+    }
+}
+
+void buttonWaiter()
+{
+    while(1){
+        waitInterrupt(1);
+        if(edge_capture == 0){
+            fail("button interrupt without an edge", 0, 0);
+        }
+        interrupts++;
+    }
+}
+
+int main(int argc, char** argv)
+{
+    int i;
+
+    for(i = 1; i < argc; i++){
+        if(i + 1 < argc && strcmp(argv[i], "-s") == 0){
+            seed = strtoul(argv[++i], NULL, 0);
+        }
+        else if(i + 1 < argc && strcmp(argv[i], "-n") == 0){
+            lastStep = strtoull(argv[++i], NULL, 0);
+        }
+        else if(i + 1 < argc && strcmp(argv[i], "-t") == 0){
+            tickSteps = strtoul(argv[++i], NULL, 0);
+        }
+        else if(i + 1 < argc && strcmp(argv[i], "-r") == 0){
+            record = openFile(argv[++i], "w");
+        }
+        else if(i + 1 < argc && strcmp(argv[i], "-p") == 0){
+            replay = openFile(argv[++i], "r");
+        }
+        else{
+            fprintf(stderr, "usage: %s [-s seed] [-n steps] [-t tick steps] [-r record] [-p replay]\n", argv[0]);
+            return 2;
+        }
+    }
+    if(seed == 0){
+        seed = 1;
+    }
+    if(tickSteps == 0){
+        tickSteps = 1;
+    }
+    if(record != NULL){
+        fprintf(record, "# seed %u, %llu steps\n", seed, lastStep);
+    }
+    if(replay != NULL){
+        readReplayEvent();
+    }
+
+    monitor = createMonitor();
+    semaphore = createSemaphore(0);
+    mutex = createMutex();
+
+    for(i = 0; i < SLEEPERS; i++){
+        createProcess(sleeper, STACK_SIZE);
+    }
+    createProcess(producer, STACK_SIZE);
+    createProcess(consumer, STACK_SIZE);
+    createProcess(poster, STACK_SIZE);
+    createProcess(taker, STACK_SIZE);
+    createProcess(locker, STACK_SIZE);
+    createProcess(locker, STACK_SIZE);
+    createProcess(buttonWaiter, STACK_SIZE);
+
+    hostSimulate(step);
+    start();
+    return 0;
+}
@@ -0,0 +1,6 @@
+#ifndef LEDS_H_
+#define LEDS_H_
+
+void LedInit();
+
+#endif /*LEDS_H_*/
@@ -0,0 +1,8 @@
+#ifndef ALT_TYPES_H_
+#define ALT_TYPES_H_
+
+typedef unsigned char alt_u8;
+typedef unsigned short alt_u16;
+typedef unsigned int alt_u32;
+
+#endif /*ALT_TYPES_H_*/
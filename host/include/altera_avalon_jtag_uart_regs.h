@@ -0,0 +1,19 @@
+#ifndef ALTERA_AVALON_JTAG_UART_REGS_H_
+#define ALTERA_AVALON_JTAG_UART_REGS_H_
+
+#include "host_io.h"
+
+#define IORD_ALTERA_AVALON_JTAG_UART_DATA(base) hostRead(base, 0)
+#define IOWR_ALTERA_AVALON_JTAG_UART_DATA(base, data) hostWrite(base, 0, data)
+#define IORD_ALTERA_AVALON_JTAG_UART_CONTROL(base) hostRead(base, 1)
+#define IOWR_ALTERA_AVALON_JTAG_UART_CONTROL(base, data) hostWrite(base, 1, data)
+
+#define ALTERA_AVALON_JTAG_UART_DATA_DATA_MSK 0x000000ff
+#define ALTERA_AVALON_JTAG_UART_DATA_RVALID_MSK 0x00008000
+
+#define ALTERA_AVALON_JTAG_UART_CONTROL_RE_MSK 0x00000001
+#define ALTERA_AVALON_JTAG_UART_CONTROL_WE_MSK 0x00000002
+#define ALTERA_AVALON_JTAG_UART_CONTROL_WSPACE_MSK 0xffff0000
+#define ALTERA_AVALON_JTAG_UART_CONTROL_WSPACE_OFST 16
+
+#endif /*ALTERA_AVALON_JTAG_UART_REGS_H_*/
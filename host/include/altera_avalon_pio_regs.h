@@ -0,0 +1,13 @@
+#ifndef ALTERA_AVALON_PIO_REGS_H_
+#define ALTERA_AVALON_PIO_REGS_H_
+
+#include "host_io.h"
+
+#define IORD_ALTERA_AVALON_PIO_DATA(base) hostRead(base, 0)
+#define IOWR_ALTERA_AVALON_PIO_DATA(base, data) hostWrite(base, 0, data)
+#define IORD_ALTERA_AVALON_PIO_IRQ_MASK(base) hostRead(base, 2)
+#define IOWR_ALTERA_AVALON_PIO_IRQ_MASK(base, data) hostWrite(base, 2, data)
+#define IORD_ALTERA_AVALON_PIO_EDGE_CAP(base) hostRead(base, 3)
+#define IOWR_ALTERA_AVALON_PIO_EDGE_CAP(base, data) hostWrite(base, 3, data)
+
+#endif /*ALTERA_AVALON_PIO_REGS_H_*/
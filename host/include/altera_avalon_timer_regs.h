@@ -0,0 +1,23 @@
+#ifndef ALTERA_AVALON_TIMER_REGS_H_
+#define ALTERA_AVALON_TIMER_REGS_H_
+
+#include "host_io.h"
+
+#define IORD_ALTERA_AVALON_TIMER_STATUS(base) hostRead(base, 0)
+#define IOWR_ALTERA_AVALON_TIMER_STATUS(base, data) hostWrite(base, 0, data)
+#define IORD_ALTERA_AVALON_TIMER_CONTROL(base) hostRead(base, 1)
+#define IOWR_ALTERA_AVALON_TIMER_CONTROL(base, data) hostWrite(base, 1, data)
+#define IOWR_ALTERA_AVALON_TIMER_PERIODL(base, data) hostWrite(base, 2, data)
+#define IOWR_ALTERA_AVALON_TIMER_PERIODH(base, data) hostWrite(base, 3, data)
+#define IORD_ALTERA_AVALON_TIMER_SNAPL(base) hostRead(base, 4)
+#define IOWR_ALTERA_AVALON_TIMER_SNAPL(base, data) hostWrite(base, 4, data)
+#define IORD_ALTERA_AVALON_TIMER_SNAPH(base) hostRead(base, 5)
+
+#define ALTERA_AVALON_TIMER_STATUS_TO_MSK 0x1
+
+#define ALTERA_AVALON_TIMER_CONTROL_ITO_MSK 0x1
+#define ALTERA_AVALON_TIMER_CONTROL_CONT_MSK 0x2
+#define ALTERA_AVALON_TIMER_CONTROL_START_MSK 0x4
+#define ALTERA_AVALON_TIMER_CONTROL_STOP_MSK 0x8
+
+#endif /*ALTERA_AVALON_TIMER_REGS_H_*/
@@ -0,0 +1,9 @@
+#ifndef HOST_IO_H_
+#define HOST_IO_H_
+
+/* Registers of the devices simulated by host/hal_host.c. reg is the
+ * register number, as in the HAL's IORD(base, reg) and IOWR. */
+unsigned int hostRead(unsigned int base, int reg);
+void hostWrite(unsigned int base, int reg, unsigned int value);
+
+#endif /*HOST_IO_H_*/
@@ -0,0 +1,8 @@
+#ifndef ALT_IRQ_H_
+#define ALT_IRQ_H_
+
+#include "alt_types.h"
+
+int alt_irq_register(alt_u32 id, void* context, void (*handler)(void*, alt_u32));
+
+#endif /*ALT_IRQ_H_*/
@@ -0,0 +1,34 @@
+#ifndef SYSTEM_H_
+#define SYSTEM_H_
+
+/* The devices of qsys_top_new.sopcinfo that the kernel uses, for the
+ * host build. The addresses only identify devices in host/hal_host.c. */
+
+#define ALT_CPU_FREQ 50000000
+
+#define BUTTONS_BASE 0x2005000
+#define BUTTONS_IRQ 2
+
+#define LED_0_BASE 0x2005020
+#define LED_1_BASE 0x2005060
+#define LED_2_BASE 0x2005040
+#define LED_COLOR_BASE 0x20050f0
+#define LED_COLOR_RESET_VALUE 0
+
+#define SWITCH_0_BASE 0x2005080
+#define SWITCH_1_BASE 0x20050e0
+
+#define TIMER_BASE 0x20050a0
+#define TIMER_IRQ 0
+#define TIMER_FREQ 50000000
+
+#define TIMER_1_BASE 0x20050c0
+#define TIMER_1_IRQ 1
+#define TIMER_1_FREQ 50000000
+
+#define JTAG_UART_0_BASE 0x2005100
+#define JTAG_UART_0_IRQ 3
+
+#define ONCHIP_MEM_BASE 0x2000000
+
+#endif /*SYSTEM_H_*/
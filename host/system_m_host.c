@@ -0,0 +1,100 @@
+/*
+ * system_m.c and the context switch of asm.s for the host build. Each
+ * process keeps its context at the bottom of the stack it is given;
+ * transfer saves the interrupt status of the process it leaves and
+ * restores that of the process it resumes, like _transfer.
+ *
+ * ucontext only starts the processes: swapcontext saves and restores the
+ * signal mask with a system call at every switch, which made switches
+ * cost more than everything else in the harness. Afterwards processes
+ * switch with _setjmp and _longjmp, which leave the mask alone.
+ */
+
+/* the checked longjmp of glibc refuses to jump to another stack */
+#undef _FORTIFY_SOURCE
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <setjmp.h>
+#include <ucontext.h>
+#include "system_m.h"
+#include "interrupt.h"
+
+typedef struct {
+    jmp_buf context; /* saved by transfer */
+    ucontext_t start; /* used once, to start the process */
+    int started;
+    void (*function)();
+} HostProcess;
+
+Process running = NULL;  // pointer to the current process.
+
+static HostProcess bootProcess;  // context of the code that performs the first transfer
+static unsigned int switches = 0;
+
+/* first code run by every process */
+static void startProcess()
+{
+    HostProcess* self = (HostProcess*) running;
+
+    /* processes start with interrupts allowed, as set up by _createStack */
+    (kernelUnlock)(1);
+    self->function();
+
+    fprintf(stderr, "Error: a process returned.\n");
+    exit(1);
+}
+
+Process newProcess(void (*f), unsigned int* stack, int stackSize){
+
+    /* ucontext_t needs more than the word alignment of the stacks */
+    unsigned long start = ((unsigned long) stack + 15) & ~15ul;
+    unsigned long end = (unsigned long) stack + stackSize;
+    HostProcess* process = (HostProcess*) start;
+
+    if(end < start + sizeof(HostProcess) + 4096){
+        fprintf(stderr, "Error: stack of %d bytes too small for the host build.\n", stackSize);
+        exit(1);
+    }
+
+    getcontext(&process->start);
+    process->start.uc_stack.ss_sp = (void*) (start + sizeof(HostProcess));
+    process->start.uc_stack.ss_size = end - start - sizeof(HostProcess);
+    process->start.uc_link = NULL;
+    process->started = 0;
+    process->function = f;
+    makecontext(&process->start, startProcess, 0);
+
+    return (Process) process;
+}
+
+void transfer(Process p){
+
+    HostProcess* from = running == NULL ? &bootProcess : (HostProcess*) running;
+    HostProcess* to = (HostProcess*) p;
+    irqState state = (kernelLock)();
+
+    running = p;
+    switches++;
+    if(_setjmp(from->context) == 0){
+        if(!to->started){
+            to->started = 1;
+            setcontext(&to->start);
+        }
+        _longjmp(to->context, 1);
+    }
+
+    /* back in this process: restore its status, which may let pending
+     * interrupts in */
+    (kernelUnlock)(state);
+}
+
+void iotransfer(Process p, int interruptV){
+
+    insertTail(interruptV, running);
+    transfer(p);
+}
+
+unsigned int switchCount(){
+    return switches;
+}
@@ -0,0 +1,139 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <system.h>
+#include <altera_avalon_pio_regs.h>
+
+#include "kernel_config.h"
+#include "interrupt.h"
+#include "kernel2.h"
+#include "input.h"
+
+/* Debounced state of every key, and how long each one has read otherwise */
+static unsigned char state[INPUT_KEYS];
+static unsigned char unstableFor[INPUT_KEYS];
+
+/* Events not read yet; the semaphore counts them */
+static InputEvent queue[INPUT_QUEUE_SIZE];
+static int first = 0;
+static int count = 0;
+static int events = -1;
+static unsigned int dropped = 0;
+
+static void checkKey(int key)
+{
+    if(key < 0 || key >= INPUT_KEYS){
+        fprintf(stderr, "Error: input key %d does not exist.\n", key);
+        exit(1);
+    }
+}
+
+static void queueEvent(int key, unsigned int time)
+{
+    if(count == INPUT_QUEUE_SIZE){
+        dropped++;
+        return;
+    }
+    InputEvent* event = &queue[(first + count++) % INPUT_QUEUE_SIZE];
+    event->key = key;
+    event->pressed = state[key];
+    event->time = time;
+    semPost(events);
+}
+
+/* feed one sample of width bits, starting at key */
+static void sampleKeys(int key, int width, int bits, unsigned int now)
+{
+    int i;
+
+    for(i = 0; i < width; i++, key++){
+        if(((bits >> i) & 1) == state[key]){
+            unstableFor[key] = 0;
+        }
+        else if(++unstableFor[key] == INPUT_DEBOUNCE_TICKS){
+            unstableFor[key] = 0;
+            state[key] = !state[key];
+            queueEvent(key, now - (INPUT_DEBOUNCE_TICKS - 1));
+        }
+    }
+}
+
+static int readButtons()
+{
+    int buttons = IORD_ALTERA_AVALON_PIO_DATA(BUTTONS_BASE);
+    return INPUT_BUTTONS_ACTIVE_LOW ? ~buttons : buttons;
+}
+
+/* timer callback, run by the clock with interrupts masked */
+static void sampleInput(void* arg)
+{
+    unsigned int now = getTicks();
+
+    sampleKeys(0, INPUT_BUTTONS, readButtons(), now);
+    sampleKeys(INPUT_SWITCH_0, INPUT_SWITCH_BITS, IORD_ALTERA_AVALON_PIO_DATA(SWITCH_0_BASE), now);
+    sampleKeys(INPUT_SWITCH_1, INPUT_SWITCH_BITS, IORD_ALTERA_AVALON_PIO_DATA(SWITCH_1_BASE), now);
+}
+
+/* start from the current levels, so that switches left on raise no event */
+static void seedKeys(int key, int width, int bits)
+{
+    int i;
+
+    for(i = 0; i < width; i++){
+        state[key + i] = (bits >> i) & 1;
+    }
+}
+
+void initInput()
+{
+    seedKeys(0, INPUT_BUTTONS, readButtons());
+    seedKeys(INPUT_SWITCH_0, INPUT_SWITCH_BITS, IORD_ALTERA_AVALON_PIO_DATA(SWITCH_0_BASE));
+    seedKeys(INPUT_SWITCH_1, INPUT_SWITCH_BITS, IORD_ALTERA_AVALON_PIO_DATA(SWITCH_1_BASE));
+
+    events = createSemaphore(0);
+    startTimer(createTimer(sampleInput, NULL, 1, 1));
+}
+
+/* take the oldest event; the caller holds a unit of the semaphore */
+static void dequeue(InputEvent* event)
+{
+    irqState irq = kernelLock();
+    *event = queue[first];
+    first = (first + 1) % INPUT_QUEUE_SIZE;
+    count--;
+    kernelUnlock(irq);
+}
+
+void inputWait(InputEvent* event)
+{
+    semWait(events);
+    dequeue(event);
+}
+
+int inputTimedWait(InputEvent* event, int msec)
+{
+    if(msec < 1 || !semTimedWait(events, msec)){
+        return 0;
+    }
+    dequeue(event);
+    return 1;
+}
+
+int inputPoll(InputEvent* event)
+{
+    if(!semTryWait(events)){
+        return 0;
+    }
+    dequeue(event);
+    return 1;
+}
+
+int inputState(int key)
+{
+    checkKey(key);
+    return state[key];
+}
+
+unsigned int inputDropped()
+{
+    return dropped;
+}
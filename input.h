@@ -0,0 +1,42 @@
+#ifndef INPUT_H_
+#define INPUT_H_
+
+#include "kernel_config.h"
+
+/* Key numbers: the buttons come first, then the bits of SWITCH_0 and of
+ * SWITCH_1. */
+#define INPUT_SWITCH_0 INPUT_BUTTONS
+#define INPUT_SWITCH_1 (INPUT_SWITCH_0 + INPUT_SWITCH_BITS)
+#define INPUT_KEYS (INPUT_SWITCH_1 + INPUT_SWITCH_BITS)
+
+/* A debounced change of one key. */
+typedef struct {
+    unsigned char key;
+    unsigned char pressed; /* 1: button pressed or switch turned on */
+    unsigned int time; /* clock tick of the first sample at the new level */
+} InputEvent;
+
+/* Function that starts the input driver, a kernel timer sampling the
+ * buttons and switches every tick. A key changes state once it has read
+ * the same for INPUT_DEBOUNCE_TICKS samples. Call it before start(). */
+void initInput();
+
+/* Function that blocks until an event is queued and removes it. */
+void inputWait(InputEvent* event);
+
+/* Function that waits at most msec ticks for an event. Returns 1 and
+ * fills *event if one came, 0 otherwise. */
+int inputTimedWait(InputEvent* event, int msec);
+
+/* Function that removes an event without blocking. Returns 0 if the
+ * queue is empty. */
+int inputPoll(InputEvent* event);
+
+/* Function that returns the debounced state of a key. */
+int inputState(int key);
+
+/* Function that returns the number of events lost because the queue
+ * was full. */
+unsigned int inputDropped();
+
+#endif /*INPUT_H_*/
@@ -1,149 +1,288 @@
-#include <stdlib.h>
-#include <stdio.h>
-#include <system.h>
-#include <sys/alt_irq.h>
-#include <alt_types.h>
-#include <altera_avalon_pio_regs.h>
-#include <altera_avalon_timer_regs.h>
-
-#include "interrupt.h"
-#include "assembly.h"
-#include "system_m.h"
-
-
-
-typedef struct ListElem{
-
-    Process p;
-    struct ListElem* next;
-    
-} ListElem;
-
-ListElem* interruptVector[2]={NULL,NULL};
-
-
-Process removeHeadI(int i){
-    
-    ListElem* removed = interruptVector[i];
-    if(interruptVector[i] != NULL){
-        interruptVector[i] = interruptVector[i] -> next;
-    }
-    if(removed != NULL){
-        Process result = removed -> p; 
-		free(removed); 
-		return result;
-    }
-    else{
-        Process result = NULL;
-        return result;
-    }  
-}
-
-void insertTail(int i, Process toBeInserted){
-    
-    ListElem* elem = malloc(sizeof(ListElem));
-    elem -> p = toBeInserted;
-    elem -> next = NULL;
-    
-    ListElem* temp= NULL;
-    if(interruptVector[i] == NULL){
-        
-       interruptVector[i] = elem; 
-    }
-    else{
-        
-        temp = interruptVector[i];
-        while((temp -> next) != NULL){
-        
-            temp = temp -> next;
-        }
-        temp -> next = elem;  
-    
-    }
-    
-        
-}
-
-/* A variable to hold the value of the button pio edge capture register. */
-volatile int edge_capture = 0;
-
-
-void handle_button_interrupts(void* context, alt_u32 id)
-{
-    
-    /* Cast context to edge_capture's type. It is important that this be 
-     * declared volatile to avoid unwanted compiler optimization.
-     */
-    volatile int* edge_capture_ptr = (volatile int*) context;
-    
-    /* Store the value in the Button's edge capture register in *context. */
-    *edge_capture_ptr = IORD_ALTERA_AVALON_PIO_EDGE_CAP(BUTTONS_BASE);
-	/* Reset the edge capture register. */
-    IOWR_ALTERA_AVALON_PIO_EDGE_CAP(BUTTONS_BASE, 0xf);
-    
-    /* Read the PIO to delay ISR exit. This is done to prevent a spurious interrupt in systems
-     * with high processor -> pio latency and fast interrupts.  */
-    IORD_ALTERA_AVALON_PIO_EDGE_CAP(BUTTONS_BASE);
-    
-    Process p2 = removeHeadI(1);
-   
-    if(p2 != NULL){
-        
-        transfer(p2);
-       
-    }
-}
-
-/* Initialize the button_pio. */
-
-void init_button()
-{
-    /* Recast the edge_capture pointer to match the alt_irq_register() function
-     * prototype. */
-    void* edge_capture_ptr = (void*) &edge_capture;
-    
-    /* Enable all 4 button interrupts. */
-    IOWR_ALTERA_AVALON_PIO_IRQ_MASK(BUTTONS_BASE, 0xf);
-    
-    /* Reset the edge capture register. */
-    IOWR_ALTERA_AVALON_PIO_EDGE_CAP(BUTTONS_BASE, 0xf);
-    
-    /* Register the interrupt handler. */
-    alt_irq_register (BUTTONS_IRQ, edge_capture_ptr, handle_button_interrupts);
-}
-
-/* A variable to set up context for timer interrupt. */
-volatile int timer_capture = 0;
-
-void handle_timer_interrupts(void* context, alt_u32 id)
-{
-	/* clear the interrupt */
-	IOWR_ALTERA_AVALON_TIMER_STATUS (TIMER_BASE, 0);
-
-	Process p2 = removeHeadI(0);
-    if(p2 != NULL){
-        transfer(p2);
-    }
-}
-
-void init_clock()
-{
-    
-  void* timer_capture_ptr = (void*) &timer_capture;  
-  /* set to free running mode */
-  IOWR_ALTERA_AVALON_TIMER_CONTROL (TIMER_BASE, 
-            ALTERA_AVALON_TIMER_CONTROL_ITO_MSK  |
-            ALTERA_AVALON_TIMER_CONTROL_CONT_MSK |
-            ALTERA_AVALON_TIMER_CONTROL_START_MSK);
-
-  /* register the interrupt handler, and enable the interrupt */ 
-  alt_irq_register (TIMER_IRQ, timer_capture_ptr, handle_timer_interrupts);  
-  
-}
-
-
-
-
-
-
-
+#include <stdlib.h>
+#include <stdio.h>
+#include <system.h>
+#include <sys/alt_irq.h>
+#include <alt_types.h>
+#include <altera_avalon_pio_regs.h>
+#include <altera_avalon_timer_regs.h>
+
+#include "kernel_config.h"
+#include "interrupt.h"
+#include "assembly.h"
+#include "system_m.h"
+#include "pool.h"
+#include "placement.h"
+#include "profile.h"
+
+typedef struct ListElem{
+
+    Process p;
+    struct ListElem* next;
+    
+} ListElem;
+
+ListElem* interruptVector[INTERRUPT_COUNT] ONCHIP_DATA = {NULL,NULL};
+
+/* List elements come from a pool so that iotransfer never touches the heap. */
+static ListElem listElemMemory[MAX_WAITERS] ONCHIP_DATA;
+static int listElemPool = -1;
+
+static void init_waiters()
+{
+    if(listElemPool == -1){
+        listElemPool = createPoolFrom(listElemMemory, sizeof(ListElem), MAX_WAITERS);
+    }
+}
+
+
+ONCHIP_CODE Process removeHeadI(int i){
+    
+    ListElem* removed = interruptVector[i];
+    if(interruptVector[i] != NULL){
+        interruptVector[i] = interruptVector[i] -> next;
+    }
+    if(removed != NULL){
+        Process result = removed -> p; 
+		poolFree(listElemPool, removed); 
+		return result;
+    }
+    else{
+        Process result = NULL;
+        return result;
+    }  
+}
+
+ONCHIP_CODE void insertTail(int i, Process toBeInserted){
+    
+    ListElem* elem = poolAlloc(listElemPool);
+    if(elem == NULL){
+        fprintf(stderr, "Error: more than %d processes waiting for interrupts!\n", MAX_WAITERS);
+        exit(1);
+    }
+    elem -> p = toBeInserted;
+    elem -> next = NULL;
+    
+    ListElem* temp= NULL;
+    if(interruptVector[i] == NULL){
+        
+       interruptVector[i] = elem; 
+    }
+    else{
+        
+        temp = interruptVector[i];
+        while((temp -> next) != NULL){
+        
+            temp = temp -> next;
+        }
+        temp -> next = elem;  
+    
+    }
+    
+        
+}
+
+int interruptWaiters(int i){
+
+    int count = 0;
+    ListElem* elem;
+
+    for(elem = interruptVector[i]; elem != NULL; elem = elem -> next){
+        count++;
+    }
+    return count;
+}
+
+/* A variable to hold the value of the button pio edge capture register. */
+volatile int edge_capture = 0;
+
+
+ONCHIP_CODE void handle_button_interrupts(void* context, alt_u32 id)
+{
+    MASKED_SINCE_HERE();
+    
+    /* Cast context to edge_capture's type. It is important that this be 
+     * declared volatile to avoid unwanted compiler optimization.
+     */
+    volatile int* edge_capture_ptr = (volatile int*) context;
+    
+    /* Store the value in the Button's edge capture register in *context. */
+    int edges = IORD_ALTERA_AVALON_PIO_EDGE_CAP(BUTTONS_BASE);
+    *edge_capture_ptr = edges;
+	/* Reset only the edges read, so that one arriving meanwhile raises
+	 * the interrupt again instead of being lost. */
+    IOWR_ALTERA_AVALON_PIO_EDGE_CAP(BUTTONS_BASE, edges);
+    
+    /* Read the PIO to delay ISR exit. This is done to prevent a spurious interrupt in systems
+     * with high processor -> pio latency and fast interrupts.  */
+    IORD_ALTERA_AVALON_PIO_EDGE_CAP(BUTTONS_BASE);
+    
+    Process p2 = removeHeadI(1);
+   
+    if(p2 != NULL){
+        
+        transfer(p2);
+       
+    }
+
+    /* the epilogue allows interrupts again, whoever transferred back */
+    MASKED_UNTIL_HERE();
+}
+
+/* Initialize the button_pio. */
+
+void init_button()
+{
+    /* Recast the edge_capture pointer to match the alt_irq_register() function
+     * prototype. */
+    void* edge_capture_ptr = (void*) &edge_capture;
+    
+    init_waiters();
+    
+    /* Enable all 4 button interrupts. */
+    IOWR_ALTERA_AVALON_PIO_IRQ_MASK(BUTTONS_BASE, 0xf);
+    
+    /* Reset the edge capture register. */
+    IOWR_ALTERA_AVALON_PIO_EDGE_CAP(BUTTONS_BASE, 0xf);
+    
+    /* Register the interrupt handler. */
+    alt_irq_register (BUTTONS_IRQ, edge_capture_ptr, handle_button_interrupts);
+}
+
+/* A variable to set up context for timer interrupt. */
+volatile int timer_capture = 0;
+
+Process clockInterrupted ONCHIP_DATA = NULL;
+
+ONCHIP_CODE void handle_timer_interrupts(void* context, alt_u32 id)
+{
+	MASKED_SINCE_HERE();
+
+	/* clear the interrupt */
+	IOWR_ALTERA_AVALON_TIMER_STATUS (TIMER_BASE, 0);
+
+#ifdef PROFILE_PC
+	profileSample(interruptedPC());
+#endif
+
+	/* running is still the interrupted process, which may be idle */
+	clockInterrupted = running;
+
+	Process p2 = removeHeadI(0);
+    if(p2 != NULL){
+        transfer(p2);
+    }
+
+    /* closes the window of the clock process too, which comes back here
+     * through iotransfer */
+    MASKED_UNTIL_HERE();
+}
+
+void init_clock()
+{
+    
+  void* timer_capture_ptr = (void*) &timer_capture;  
+  
+  init_waiters();
+  
+  /* set to free running mode */
+  IOWR_ALTERA_AVALON_TIMER_CONTROL (TIMER_BASE, 
+            ALTERA_AVALON_TIMER_CONTROL_ITO_MSK  |
+            ALTERA_AVALON_TIMER_CONTROL_CONT_MSK |
+            ALTERA_AVALON_TIMER_CONTROL_START_MSK);
+
+  /* register the interrupt handler, and enable the interrupt */ 
+  alt_irq_register (TIMER_IRQ, timer_capture_ptr, handle_timer_interrupts);  
+  
+}
+
+void init_timestamp()
+{
+  /* count down from the largest period, forever */
+  IOWR_ALTERA_AVALON_TIMER_CONTROL (TIMER_1_BASE, ALTERA_AVALON_TIMER_CONTROL_STOP_MSK);
+  IOWR_ALTERA_AVALON_TIMER_PERIODL (TIMER_1_BASE, 0xFFFF);
+  IOWR_ALTERA_AVALON_TIMER_PERIODH (TIMER_1_BASE, 0xFFFF);
+  IOWR_ALTERA_AVALON_TIMER_CONTROL (TIMER_1_BASE,
+            ALTERA_AVALON_TIMER_CONTROL_CONT_MSK |
+            ALTERA_AVALON_TIMER_CONTROL_START_MSK);
+}
+
+unsigned int timestamp()
+{
+  /* the parentheses call the functions themselves, never the profiling macros */
+  irqState state = (kernelLock)();
+  
+  /* writing the snapshot register latches the counter into it */
+  IOWR_ALTERA_AVALON_TIMER_SNAPL (TIMER_1_BASE, 0);
+  unsigned int count = (IORD_ALTERA_AVALON_TIMER_SNAPH (TIMER_1_BASE) & 0xFFFF) << 16;
+  count |= IORD_ALTERA_AVALON_TIMER_SNAPL (TIMER_1_BASE) & 0xFFFF;
+  
+  (kernelUnlock)(state);
+  
+  /* the counter goes down; make the timestamp go up */
+  return ~count;
+}
+
+/* Start of the current masked window and the longest one seen so far. */
+static unsigned int maskedStart = 0;
+static const char* maskedFile = NULL;
+static int maskedLine = 0;
+static MaskedProfile longestMasked = {0, NULL, 0, NULL, 0};
+
+void maskedSince(const char* file, int line)
+{
+  maskedStart = timestamp();
+  maskedFile = file;
+  maskedLine = line;
+}
+
+irqState kernelLockAt(const char* file, int line)
+{
+  irqState state = (kernelLock)();
+  
+  /* only the outermost lock opens a window */
+  if(irqEnabled(state)){
+      maskedSince(file, line);
+  }
+  return state;
+}
+
+void maskedUntil(const char* file, int line)
+{
+  if(maskedFile != NULL){
+      unsigned int cycles = timestamp() - maskedStart;
+      if(cycles > longestMasked.cycles){
+          longestMasked.cycles = cycles;
+          longestMasked.lockFile = maskedFile;
+          longestMasked.lockLine = maskedLine;
+          longestMasked.unlockFile = file;
+          longestMasked.unlockLine = line;
+      }
+      maskedFile = NULL;
+  }
+}
+
+void kernelUnlockAt(irqState state, const char* file, int line)
+{
+  if(irqEnabled(state)){
+      maskedUntil(file, line);
+  }
+  (kernelUnlock)(state);
+}
+
+void getMaskedProfile(MaskedProfile* profile)
+{
+  irqState state = (kernelLock)();
+  *profile = longestMasked;
+  (kernelUnlock)(state);
+}
+
+void resetMaskedProfile()
+{
+  irqState state = (kernelLock)();
+  longestMasked.cycles = 0;
+  longestMasked.lockFile = NULL;
+  longestMasked.lockLine = 0;
+  longestMasked.unlockFile = NULL;
+  longestMasked.unlockLine = 0;
+  (kernelUnlock)(state);
+}
@@ -1,23 +1,91 @@
-#ifndef INTERRUPT_H_
-#define INTERRUPT_H_
-
-#include "system_m.h"
-
-/* Function that enables all 4 button interrupts and that resets the edge capture register. */
-void init_button();
-
-/* Function that enables clock interrupts. */
-void init_clock();
-
-/* Function used in implementation of iotransfer. */ 
-void insertTail(int i, Process toBeInserted);
-
-extern volatile int edge_capture;
-
-/* Function that masks all interrupts. */
-void maskInterrupts();
-
-/* Function that allows all interrupts. */
-void allowInterrupts();
-
-#endif /*INTERRUPT_H_*/
+#ifndef INTERRUPT_H_
+#define INTERRUPT_H_
+
+#include "kernel_config.h"
+#include "system_m.h"
+
+/* Function that enables all 4 button interrupts and that resets the edge capture register. */
+void init_button();
+
+/* Function that enables clock interrupts. */
+void init_clock();
+
+/* Function used in implementation of iotransfer. */ 
+void insertTail(int i, Process toBeInserted);
+
+extern volatile int edge_capture;
+
+/* Process that was running when the last clock interrupt came in. */
+extern Process clockInterrupted ONCHIP_DATA;
+
+/* Function that returns the number of processes waiting for interrupt i. */
+int interruptWaiters(int i);
+
+/* Function that masks all interrupts. */
+void maskInterrupts();
+
+/* Function that allows all interrupts. */
+void allowInterrupts();
+
+/* Function that returns 1 if interrupts are allowed, 0 if they are masked. */
+int interruptsEnabled();
+
+/* Saved interrupt switch status, as returned by kernelLock. */
+typedef unsigned int irqState;
+
+/* Checks if interrupts were allowed in a saved state. */
+#define irqEnabled(state) ((state) & 1)
+
+/* Function that masks all interrupts and returns the previous state. Unlike
+ * maskInterrupts, it may be nested: every kernelLock must be paired with a
+ * kernelUnlock of the state it returned. */
+irqState kernelLock();
+
+/* Function that restores the interrupt state saved by kernelLock. */
+void kernelUnlock(irqState state);
+
+/* Function that starts timer_1 as a free running cycle counter. */
+void init_timestamp();
+
+/* Function that returns the number of cycles counted by timer_1. */
+unsigned int timestamp();
+
+/* Compiling with -DPROFILE_MASKED records the longest window during which
+ * interrupts stayed masked, with the places where it began and ended. */
+typedef struct {
+    unsigned int cycles;
+    const char* lockFile;
+    int lockLine;
+    const char* unlockFile;
+    int unlockLine;
+} MaskedProfile;
+
+#ifdef PROFILE_MASKED
+#define kernelLock() kernelLockAt(__FILE__, __LINE__)
+#define kernelUnlock(state) kernelUnlockAt(state, __FILE__, __LINE__)
+#define MASKED_SINCE_HERE() maskedSince(__FILE__, __LINE__)
+#define MASKED_UNTIL_HERE() maskedUntil(__FILE__, __LINE__)
+#else
+#define MASKED_SINCE_HERE()
+#define MASKED_UNTIL_HERE()
+#endif
+
+irqState kernelLockAt(const char* file, int line);
+void kernelUnlockAt(irqState state, const char* file, int line);
+
+/* Function that marks the start of a window masked by the hardware, such as
+ * the entry of an interrupt handler. */
+void maskedSince(const char* file, int line);
+
+/* Function that marks the end of a window that the hardware closes, such
+ * as the exit of an interrupt handler. A window opened by a process that
+ * then switched to a preempted one ends there too. */
+void maskedUntil(const char* file, int line);
+
+/* Function that copies the longest masked window recorded so far. */
+void getMaskedProfile(MaskedProfile* profile);
+
+/* Function that forgets the longest masked window. */
+void resetMaskedProfile();
+
+#endif /*INTERRUPT_H_*/
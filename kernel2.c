@@ -1,501 +1,1919 @@
-#include <stdio.h>
-#include <stdlib.h>
-#include <string.h>
-#include "Leds.h"
-#include "system_m.h"
-#include "interrupt.h"
-#include "kernel2.h"
-
-/************* Symbolic constants and macros ************/
-#define MAX_PROC 10
-#define MAX_MONITORS 10
-
-#define INTERRUPT_COUNT 2
-#define TIME_SLICE 20
-#define STACK_SIZE 10000
-
-#define DPRINTA(text, ...) printf("[%d] " text "\n", head(&readyList), __VA_ARGS__)
-#define DPRINT(text) DPRINTA(text, 0)
-#define ERRA(text, ...) fprintf(stderr, "[%d] Error: " text "\n", head(&readyList), __VA_ARGS__)
-#define ERR(text) ERRA(text, 0)
-
-
-/************* Data structures **************/
-typedef struct {
-    int next;
-    Process p;
-    int currentMonitor;/* points to the monitors array */
-    int monitors[MAX_MONITORS + 1]; /* used for nested calls;
-                                     * monitors[0] is always -1 */
-    int time_ct;
-} ProcessDescriptor;
-
-typedef struct {
-    int timesTaken;
-    int takenBy;
-    int entryList;
-    int waitingList;
-    int timedWaitList;
-} MonitorDescriptor;
-
-/********************** Global variables **********************/
-
-/* Pointer to the head of the ready list */
-static int readyList = -1;
-
-/* Pointer to the head of sleeping processes */
-static int sleepingList = -1;
-
-/* List of process descriptors */
-ProcessDescriptor processes[MAX_PROC];
-static int nextProcessId = 0;
-
-/* List of monitor descriptors */
-MonitorDescriptor monitors[MAX_MONITORS];
-static int nextMonitorId = 0;
-
-/*************** Functions for process list manipulation **********/
-
-/** Kernel processes **/
-static Process idle;
-static Process clk;
-
-/* add element to the tail of the list */
-static void addLast(int* list, int processId) {
-    if(processId == -1) {
-        return;
-    }
-
-    if (*list == -1) {
-        *list = processId;
-    }
-    else {
-        int temp = *list;
-        while (processes[temp].next != -1){
-            temp = processes[temp].next;
-        }
-        processes[temp].next = processId;
-    }
-    processes[processId].next = -1;
-}
-
-/* add element to the head of list */
-static void addFirst(int* list, int processId){
-    if(processId == -1) {
-        return;
-    }
-    processes[processId].next = *list;
-    *list = processId;
-}
-
-/* remove an element from the head of the list */
-static int removeHead(int* list){
-    if (*list == -1){
-        return(-1);
-    }
-    else {
-        int head = *list;
-        int next = processes[*list].next;
-        processes[*list].next = -1;
-        *list = next;
-        return head;
-    }
-}
-
-/* returns the head of the list */
-static int head(int* list){
-    return *list;
-}
-
-/* checks if the list is empty */
-static int isEmpty(int* list) {
-    return *list < 0;
-}
-
-/***********************************************************
- ***********************************************************
-                    Kernel functions
-                    ************************************************************
-                    *
-                    * **********************************************************/
-
-void createProcess (void (*f)(), int stackSize) {
-    if (nextProcessId == MAX_PROC){
-        ERR("Maximum number of processes reached!");
-        exit(1);
-    }
-    unsigned int* stack = malloc(stackSize);
-    if (stack==NULL) {
-        ERR("Could not allocate stack. Exiting...");
-        exit(1);
-    }
-    processes[nextProcessId].p = newProcess(f, stack, stackSize);
-    processes[nextProcessId].next = -1;
-    processes[nextProcessId].currentMonitor = 0;
-    processes[nextProcessId].monitors[0] = -1;
-
-    addLast(&readyList, nextProcessId);
-    nextProcessId++;
-}
-
-static void checkAndTransfer() {
-    if(isEmpty(&readyList)) {
-        transfer(idle);
-    }
-    else {
-        Process process = processes[head(&readyList)].p;
-        transfer(process);
-    }
-}
-
-static void idleFunc() {
-    allowInterrupts();
-    while(1);
-}
-
-static void clockHandler() {
-    static int counter = TIME_SLICE;
-    size_t i;
-
-    DPRINT("Starting clock process");
-
-    maskInterrupts();
-
-    init_clock();
-
-    while(1) {
-        if(isEmpty(&readyList)) {
-            iotransfer(idle, 0);
-        }
-        else {
-            iotransfer(processes[head(&readyList)].p, 0);
-        }
-        counter--;
-        if(counter == 0) {
-            counter = TIME_SLICE;
-            addLast(&readyList, removeHead(&readyList));
-        }
-
-        int pid = head(&sleepingList);
-        if(pid != -1) {
-            do {
-                //Pour faire ça correctement il faudrait supporter la
-                //suppression dans la liste au milieu parce que ce
-                //n'est pas forcément le process en tête de liste qui
-                //a fini de sleep !
-                int npid = processes[pid].next;
-                processes[pid].time_ct--;
-                if(processes[pid].time_ct <= 0) {
-                    addLast(&readyList, removeHead(&sleepingList));
-                }
-                pid = npid;
-            } while(pid != -1);
-        }
-
-        for(i = 0 ; i < nextMonitorId ; i++) {
-            int pid = head(&(monitors[i].timedWaitList));
-            if(pid != -1) {
-                do {
-                    int npid = processes[pid].next ;
-                    processes[pid].time_ct--;
-                    if(processes[pid].time_ct <= 0) {
-                        //Même commentaire qu'au dessus
-                        if (monitors[i].takenBy != -1) {
-                            addLast(&(monitors[i].entryList), removeHead(&(monitors[i].timedWaitList)));
-                        }
-                        else {
-                            monitors[i].takenBy = pid;
-                            monitors[i].timesTaken++;
-                            addLast(&readyList, removeHead(&(monitors[i].timedWaitList)));
-                        }
-                    }
-                    pid = npid;
-                } while(pid != -1);
-            }
-        }
-    }
-}
-
-void start() {
-    LedInit();
-    DPRINT("Starting kernel...");
-
-    init_button();
-
-    unsigned int* temp_sp = NULL;
-
-    temp_sp = malloc(STACK_SIZE);
-
-    if(temp_sp == NULL)  {
-        ERR("Failed to allocate stack for idle process!");
-        exit(1);
-    }
-
-    idle = newProcess(idleFunc, temp_sp, STACK_SIZE);
-
-    temp_sp = malloc(STACK_SIZE);
-
-    if(temp_sp == NULL) {
-        ERR("Failed to allocate stack for clock process!");
-        exit(1);
-    }
-
-    clk = newProcess(clockHandler, temp_sp, STACK_SIZE);
-
-    transfer(clk);
-}
-
-void yield(){
-    int pid = removeHead(&readyList);
-    addLast(&readyList, pid);
-    checkAndTransfer();
-}
-
-int createMonitor(){
-    if (nextMonitorId == MAX_MONITORS){
-        ERR("Maximum number of monitors reached!\n");
-        exit(1);
-    }
-    monitors[nextMonitorId].timesTaken = 0;
-    monitors[nextMonitorId].takenBy = -1;
-    monitors[nextMonitorId].entryList = -1;
-    monitors[nextMonitorId].waitingList = -1;
-    monitors[nextMonitorId].timedWaitList = -1;
-    return nextMonitorId++;
-}
-
-static int getCurrentMonitor(int pid) {
-    return processes[pid].monitors[processes[pid].currentMonitor];
-}
-
-void enterMonitor(int monitorID) {
-    maskInterrupts();
-
-    int myID = head(&readyList);
-
-    if (monitorID > nextMonitorId || monitorID < 0) {
-        ERRA("Monitor %d does not exist.", nextMonitorId);
-        exit(1);
-    }
-
-    if (processes[myID].currentMonitor >= MAX_MONITORS) {
-        ERR("Too many nested calls.");
-        exit(1);
-    }
-
-    if (monitors[monitorID].timesTaken > 0 && monitors[monitorID].takenBy != myID) {
-        removeHead(&readyList);
-        addLast(&(monitors[monitorID].entryList), myID);
-        checkAndTransfer();
-
-        /* I am woken up by exitMonitor -- check if the monitor state
-         * is consistent */
-        if ((monitors[monitorID].timesTaken != 1) || (monitors[monitorID].takenBy != myID)) {
-            ERR("The kernel has performed an illegal operation. Please contact customer support.");
-            exit(1);
-        }
-    }
-    else {
-        monitors[monitorID].timesTaken++;
-        monitors[monitorID].takenBy = myID;
-    }
-
-    /* push the new call onto the call stack */
-    processes[myID].monitors[++processes[myID].currentMonitor] = monitorID;
-    allowInterrupts();
-}
-
-void exitMonitor() {
-    maskInterrupts();
-
-    int myID = head(&readyList);
-    int myMonitor = getCurrentMonitor(myID);
-
-
-    if (myMonitor < 0) {
-        ERRA("Process %d called exitMonitor outside of a monitor.", myID);
-        exit(1);
-    }
-
-    /* go backwards in the stack of called monitors */
-    processes[myID].currentMonitor--;
-
-    if (--monitors[myMonitor].timesTaken == 0) {
-        /* see if someone is waiting, and if yes, let the next process
-         * in */
-        if (!isEmpty(&(monitors[myMonitor].entryList))) {
-            int pid = removeHead(&(monitors[myMonitor].entryList));
-            addLast(&readyList, pid);
-            monitors[myMonitor].timesTaken = 1;
-            monitors[myMonitor].takenBy = pid;
-        } else {
-            monitors[myMonitor].takenBy = -1;
-        }
-    }
-    allowInterrupts();
-}
-
-void wait() {
-    int myID = head(&readyList);
-    int myMonitor = getCurrentMonitor(myID);
-    int myTaken;
-
-    maskInterrupts();
-
-    if (myMonitor < 0) {
-        ERRA("Process %d called wait outside of a monitor.", myID);
-        exit(1);
-    }
-
-    removeHead(&readyList);
-    addLast(&monitors[myMonitor].waitingList, myID);
-
-    /* save timesTaken so we can restore it later */
-    myTaken = monitors[myMonitor].timesTaken;
-
-    /* let the next process in, if any */
-    if (!isEmpty(&(monitors[myMonitor].entryList))) {
-        int pid = removeHead(&(monitors[myMonitor].entryList));
-        addLast(&readyList, pid);
-        monitors[myMonitor].timesTaken = 1;
-        monitors[myMonitor].takenBy = pid;
-    } else {
-        monitors[myMonitor].timesTaken = 0;
-        monitors[myMonitor].takenBy = -1;
-    }
-    checkAndTransfer();
-
-    /* I am woken up by exitMonitor -- check if the monitor state is
-     * consistent */
-    if ((monitors[myMonitor].timesTaken != 1) || (monitors[myMonitor].takenBy != myID)) {
-        ERR("The kernel has performed an illegal operation. Please contact customer support.");
-        exit(1);
-    }
-
-    /* we're back, restore timesTaken */
-    monitors[myMonitor].timesTaken = myTaken;
-    allowInterrupts();
-}
-
-void notify() {
-    maskInterrupts();
-
-    int myID = head(&readyList);
-    int myMonitor = getCurrentMonitor(myID);
-
-    if (myMonitor < 0) {
-        ERRA("Process %d called notify outside of a monitor.", myID);
-        exit(1);
-    }
-
-    if (!isEmpty(&(monitors[myMonitor].timedWaitList))) {
-        int pid = removeHead(&monitors[myMonitor].timedWaitList);
-        addLast(&monitors[myMonitor].entryList, pid);
-    }
-    else if (!isEmpty(&(monitors[myMonitor].waitingList))) {
-        int pid = removeHead(&monitors[myMonitor].waitingList);
-        addLast(&monitors[myMonitor].entryList, pid);
-    }
-    allowInterrupts();
-}
-
-void notifyAll() {
-    maskInterrupts();
-
-    int myID = head(&readyList);
-    int myMonitor = getCurrentMonitor(myID);
-
-    if (myMonitor < 0) {
-        ERRA("Process %d called notify outside of a monitor.", myID);
-        exit(1);
-    }
-
-
-    while(!isEmpty(&monitors[myMonitor].timedWaitList)) {
-        int pid = removeHead(&monitors[myMonitor].timedWaitList);
-        addLast(&monitors[myMonitor].entryList, pid);
-    }
-
-    while (!isEmpty(&(monitors[myMonitor].waitingList))) {
-        int pid = removeHead(&monitors[myMonitor].waitingList);
-        addLast(&monitors[myMonitor].entryList, pid);
-    }
-
-    allowInterrupts();
-}
-
-int timedWait(int time) {
-    maskInterrupts();
-
-    if (time == 0) { //If time is 0 just wait
-        wait();
-        return 1;
-    }
-
-    int myID = removeHead(&readyList);
-    int myMonitor = getCurrentMonitor(myID);
-
-    if(myMonitor < 0) {
-        ERRA("Process %d called timedWait outside of a monitor.", myID);
-        exit(1);
-    }
-
-    processes[myID].time_ct = time;
-
-    if (!isEmpty(&(monitors[myMonitor].entryList))) {
-        int pid = removeHead(&(monitors[myMonitor].entryList));
-        addLast(&readyList, pid);
-        monitors[myMonitor].timesTaken = 1;
-        monitors[myMonitor].takenBy = pid;
-    } else {
-        monitors[myMonitor].timesTaken = 0;
-        monitors[myMonitor].takenBy = -1;
-    }
-
-    addLast(&monitors[myMonitor].timedWaitList, myID);
-
-    checkAndTransfer();
-
-    allowInterrupts();
-
-    return processes[head(&readyList)].time_ct > 0;
-}
-
-void sleep(int msec){
-    maskInterrupts();
-
-    int myID = removeHead(&readyList);
-
-    processes[myID].time_ct = msec; //Update the wait time for this process
-
-    addLast(&sleepingList, myID); // Put it in the sleeping list
-
-    checkAndTransfer(); //Transfer control
-
-    allowInterrupts();
-}
-
-void waitInterrupt(int per){
-    if(per < 0 || per >= INTERRUPT_COUNT){
-        ERRA("Waiting for invalid interrupt %d!\n", per);
-        exit(1);
-    }
-
-    maskInterrupts();
-
-    int pid = removeHead(&readyList);
-    Process p;
-
-    if(per != 0) {
-        //On ne peut avoir que clk qui attend sur les interruptions du timer
-        if(isEmpty(&readyList)) {
-            p = idle;
-        }
-        else {
-            p = processes[head(&readyList)].p;
-        }
-        iotransfer(p, per);
-        addFirst(&readyList, pid);
-    }
-    allowInterrupts();
-}
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "Leds.h"
+#include "kernel_config.h"
+#include "system_m.h"
+#include "interrupt.h"
+#include "pool.h"
+#include "placement.h"
+#include "log.h"
+#include "kernel2.h"
+
+/************* Symbolic constants and macros ************/
+/* sizes are set in kernel_config.h */
+
+#define DPRINTA(text, ...) klog("[%d] " text "\n", head(&readyList), __VA_ARGS__)
+#define DPRINT(text) DPRINTA(text, 0)
+#define ERRA(text, ...) fprintf(stderr, "[%d] Error: " text "\n", head(&readyList), __VA_ARGS__)
+#define ERR(text) ERRA(text, 0)
+
+/* Whether new processes are rotated by the clock */
+#ifdef COOPERATIVE_SCHEDULING
+#define DEFAULT_PREEMPTIBLE 0
+#else
+#define DEFAULT_PREEMPTIBLE 1
+#endif
+
+/* Quantum of a scheduling level, in clock ticks */
+#define QUANTUM(level) (MLFQ_QUANTUM << (level))
+
+/* Profiling of kernel calls; the contended flag is evaluated either way.
+ * CALL_BLOCKED wraps a switch away from the caller, so that the time until
+ * it runs again is counted as waiting, apart from the cost of the call. */
+#ifdef PROFILE_CALLS
+#define CALL_START() unsigned int callStart = timestamp(); unsigned int callBlocked = 0
+#define CALL_BLOCKED(statement) \
+    do { unsigned int blockStart = timestamp(); statement; callBlocked += timestamp() - blockStart; } while (0)
+#define CALL_END(call, contended) recordCall(call, callStart, callBlocked, contended)
+#else
+#define CALL_START()
+#define CALL_BLOCKED(statement) statement
+#define CALL_END(call, contended) ((void)(contended))
+#endif
+
+
+/************* Data structures **************/
+
+/* Process and monitor indexes are stored in the smallest type that holds
+ * them and -1 */
+#if MAX_PROC < 128
+typedef signed char ProcessIndex;
+#else
+typedef short ProcessIndex;
+#endif
+
+#if MAX_MONITORS < 128
+typedef signed char MonitorIndex;
+#else
+typedef short MonitorIndex;
+#endif
+
+/* Queue of processes. Processes are linked through processLinks, so a
+ * process is in at most one queue at a time. */
+typedef struct {
+    ProcessIndex head;
+    ProcessIndex tail;
+} ProcessQueue;
+
+#define EMPTY_QUEUE {-1, -1}
+
+typedef struct {
+    ProcessIndex next;
+    ProcessIndex prev;
+} ProcessLinks;
+
+/* Fields of a process that are not used by the scheduler; the links and
+ * Process fields live in the processLinks and processHandles arrays so
+ * that list walks stay within a few cache lines */
+typedef struct {
+    MonitorIndex monitors[NESTING_DEPTH]; /* used for nested calls;
+                                           * innermost call last */
+    unsigned char nesting; /* number of calls in monitors */
+    unsigned char preemptible; /* rotated by the clock every TIME_SLICE */
+    signed char interrupt; /* interrupt waited for, or -1 */
+#ifdef MLFQ_SCHEDULING
+    unsigned char level; /* 0 runs first */
+    unsigned short slice; /* ticks run of the current quantum */
+    unsigned short burst; /* ticks run since the process was last woken */
+#endif
+    int time_ct;
+} ProcessDescriptor;
+
+typedef struct {
+    unsigned char timesTaken;
+    ProcessIndex takenBy;
+    ProcessQueue entryList;
+    ProcessQueue waitingList;
+    ProcessQueue timedWaitList;
+    unsigned char rw; /* reader-writer monitor */
+    unsigned char readers; /* shared entries held by readers */
+    ProcessQueue sharedList; /* readers waiting to enter */
+    ProcessIndex notified; /* process handed the monitor next, or -1 */
+} MonitorDescriptor;
+
+typedef struct {
+    void (*callback)(void*);
+    void* arg;
+    int period;
+    int periodic;
+    unsigned int expiry; /* absolute tick at which the timer fires */
+    int heapIndex; /* position in timerHeap; -1 when not armed */
+} TimerDescriptor;
+
+typedef struct {
+    void (*handler)(void*);
+    void* arg;
+    int priority; /* lower value runs first */
+} TaskletDescriptor;
+
+typedef struct {
+    void* ring[MAX_CHANNEL_DEPTH]; /* buffers in transit, oldest at first */
+    int first;
+    int count;
+    int depth;
+    int pool; /* pool the buffers are released to */
+    ProcessQueue receiveList; /* processes waiting for a buffer */
+    ProcessQueue sendList; /* processes waiting for a free slot */
+} ChannelDescriptor;
+
+typedef struct {
+    int count;
+    ProcessQueue waitList; /* time_ct > 0 for timed waits, -1 otherwise */
+} SemaphoreDescriptor;
+
+typedef struct {
+    volatile ProcessIndex owner; /* -1 when free */
+    ProcessQueue waitList;
+} MutexDescriptor;
+
+/********************** Global variables **********************/
+
+/* Ready processes; the running one is at the head */
+static ProcessQueue readyList ONCHIP_DATA = EMPTY_QUEUE;
+
+/* Sleeping processes */
+static ProcessQueue sleepingList ONCHIP_DATA = EMPTY_QUEUE;
+
+/* Links to the neighbours of each process in the queue it is in */
+ProcessLinks processLinks[MAX_PROC] ONCHIP_DATA;
+
+/* Saved context of each process */
+Process processHandles[MAX_PROC] ONCHIP_DATA;
+
+/* List of process descriptors */
+ProcessDescriptor processes[MAX_PROC];
+static int nextProcessId = 0;
+
+/* List of monitor descriptors */
+MonitorDescriptor monitors[MAX_MONITORS] ONCHIP_DATA;
+static int nextMonitorId = 0;
+
+/* List of software timer descriptors */
+TimerDescriptor timers[MAX_TIMERS];
+static int nextTimerId = 0;
+
+/* Min-heap of armed timers, ordered by expiry */
+static int timerHeap[MAX_TIMERS];
+static int timerHeapSize = 0;
+
+/* Number of clock ticks since the kernel started */
+static unsigned int clockTicks = 0;
+
+/* List of tasklet descriptors */
+TaskletDescriptor tasklets[MAX_TASKLETS];
+static int nextTaskletId = 0;
+
+/* Tasklet ids sorted by priority */
+static int taskletOrder[MAX_TASKLETS];
+
+/* One bit per posted tasklet that has not run yet */
+static volatile unsigned int taskletPending = 0;
+
+/* List of channel descriptors */
+ChannelDescriptor channels[MAX_CHANNELS];
+static int nextChannelId = 0;
+
+/* List of semaphore descriptors */
+SemaphoreDescriptor semaphores[MAX_SEMAPHORES];
+static int nextSemaphoreId = 0;
+
+/* List of mutex descriptors */
+MutexDescriptor mutexes[MAX_MUTEXES] ONCHIP_DATA;
+static int nextMutexId = 0;
+
+/* Background work run by the idle process */
+static void (*idleHooks[MAX_IDLE_HOOKS])();
+static int idleHookCount = 0;
+
+/* Cycles spent in the idle loop, as measured by the idle process */
+static volatile unsigned int idleCycles = 0;
+
+/* Busy time of each of the last LOAD_HISTORY seconds, in permille */
+static unsigned short loadHistory[LOAD_HISTORY];
+static int loadIndex = 0; /* next entry to write */
+static int loadSamples = 0;
+
+#ifdef PROFILE_CALLS
+/* Counters of each kernel call; avgCycles is computed when read */
+static CallProfile callProfiles[KERNEL_CALLS];
+static unsigned long long callCycles[KERNEL_CALLS];
+static unsigned long long callWaitCycles[KERNEL_CALLS];
+
+/* add one call that started at start, and was blocked for blocked cycles */
+static void recordCall(int call, unsigned int start, unsigned int blocked, int contended) {
+    unsigned int cycles = timestamp() - start - blocked;
+    irqState state = kernelLock();
+    CallProfile* profile = &callProfiles[call];
+
+    if (profile->count == 0 || cycles < profile->minCycles) {
+        profile->minCycles = cycles;
+    }
+    if (cycles > profile->maxCycles) {
+        profile->maxCycles = cycles;
+    }
+    if (blocked > profile->maxWaitCycles) {
+        profile->maxWaitCycles = blocked;
+    }
+    profile->count++;
+    profile->contended += contended != 0;
+    callCycles[call] += cycles;
+    callWaitCycles[call] += blocked;
+    kernelUnlock(state);
+}
+#endif
+
+#ifdef MLFQ_SCHEDULING
+/* Counters of each scheduling level; processes is computed when read */
+static LevelStats levelStats[MLFQ_LEVELS];
+#endif
+
+/*************** Functions for process list manipulation **********/
+
+/** Kernel processes **/
+static Process idle;
+static Process clk;
+static Process tasklet = NULL; /* runs tasklets on a single shared stack */
+
+/* Process to return to once all pending tasklets have run */
+static Process taskletCaller;
+
+/* Stacks of the kernel processes */
+static unsigned int idleStack[KERNEL_STACK_SIZE / sizeof(unsigned int)] ONCHIP_STACK;
+static unsigned int clkStack[KERNEL_STACK_SIZE / sizeof(unsigned int)] ONCHIP_STACK;
+static unsigned int taskletStack[KERNEL_STACK_SIZE / sizeof(unsigned int)] ONCHIP_STACK;
+
+/* Processes declared in kernel_config.h, with their stacks */
+#define DECLARE_TASK(function, stackSize) \
+    void function(); \
+    static unsigned int function##Stack[(stackSize) / sizeof(unsigned int)];
+KERNEL_TASKS(DECLARE_TASK)
+
+#define COUNT_TASK(function, stackSize) + 1
+enum { STATIC_TASK_COUNT = 0 KERNEL_TASKS(COUNT_TASK) };
+
+/* fails to compile if the declared processes do not fit in MAX_PROC */
+typedef char staticTasksFit[STATIC_TASK_COUNT <= MAX_PROC ? 1 : -1];
+
+static ONCHIP_CODE void initQueue(ProcessQueue* queue) {
+    queue->head = -1;
+    queue->tail = -1;
+}
+
+/* add element to the tail of the queue */
+static ONCHIP_CODE void addLast(ProcessQueue* queue, int processId) {
+    if(processId == -1) {
+        return;
+    }
+
+    processLinks[processId].next = -1;
+    processLinks[processId].prev = queue->tail;
+    if (queue->tail == -1) {
+        queue->head = processId;
+    }
+    else {
+        processLinks[queue->tail].next = processId;
+    }
+    queue->tail = processId;
+}
+
+/* add element to the head of the queue */
+static ONCHIP_CODE void addFirst(ProcessQueue* queue, int processId){
+    if(processId == -1) {
+        return;
+    }
+
+    processLinks[processId].next = queue->head;
+    processLinks[processId].prev = -1;
+    if (queue->head == -1) {
+        queue->tail = processId;
+    }
+    else {
+        processLinks[queue->head].prev = processId;
+    }
+    queue->head = processId;
+}
+
+/* remove an element from anywhere in the queue it is in; returns it */
+static ONCHIP_CODE int removeElement(ProcessQueue* queue, int processId) {
+    int next = processLinks[processId].next;
+    int prev = processLinks[processId].prev;
+
+    if (prev == -1) {
+        queue->head = next;
+    }
+    else {
+        processLinks[prev].next = next;
+    }
+    if (next == -1) {
+        queue->tail = prev;
+    }
+    else {
+        processLinks[next].prev = prev;
+    }
+    processLinks[processId].next = -1;
+    processLinks[processId].prev = -1;
+    return processId;
+}
+
+/* remove an element from the head of the queue */
+static ONCHIP_CODE int removeHead(ProcessQueue* queue){
+    if (queue->head == -1){
+        return(-1);
+    }
+    return removeElement(queue, queue->head);
+}
+
+/* returns the head of the queue */
+static ONCHIP_CODE int head(ProcessQueue* queue){
+    return queue->head;
+}
+
+/* returns the element after processId in its queue, -1 at the tail */
+static ONCHIP_CODE int nextInQueue(int processId) {
+    return processLinks[processId].next;
+}
+
+/* checks if the queue is empty */
+static ONCHIP_CODE int isEmpty(ProcessQueue* queue) {
+    return queue->head < 0;
+}
+
+/* move all the elements of from to the tail of to, in order */
+static ONCHIP_CODE void spliceLast(ProcessQueue* to, ProcessQueue* from) {
+    if (isEmpty(from)) {
+        return;
+    }
+
+    if (to->tail == -1) {
+        to->head = from->head;
+    }
+    else {
+        processLinks[to->tail].next = from->head;
+        processLinks[from->head].prev = to->tail;
+    }
+    to->tail = from->tail;
+    initQueue(from);
+}
+
+#ifdef MLFQ_SCHEDULING
+/* add element before next in the queue, or at its tail if next is -1 */
+static ONCHIP_CODE void insertBefore(ProcessQueue* queue, int next, int processId) {
+    if (next == -1) {
+        addLast(queue, processId);
+        return;
+    }
+
+    processLinks[processId].next = next;
+    processLinks[processId].prev = processLinks[next].prev;
+    if (processLinks[next].prev == -1) {
+        queue->head = processId;
+    }
+    else {
+        processLinks[processLinks[next].prev].next = processId;
+    }
+    processLinks[next].prev = processId;
+}
+#endif
+
+/*************** Functions for the scheduling levels **********/
+
+#ifdef MLFQ_SCHEDULING
+/* add a process to the ready list behind the processes of its level or a
+ * better one, but never ahead of first */
+static ONCHIP_CODE void addByLevel(int first, int processId) {
+    int next = -1;
+    int prev = readyList.tail;
+
+    while (prev != -1 && prev != first && processes[prev].level > processes[processId].level) {
+        next = prev;
+        prev = processLinks[prev].prev;
+    }
+    insertBefore(&readyList, next, processId);
+}
+
+/* add a process to the ready list ahead of the processes of its level or
+ * a worse one, but behind those of a better level */
+static ONCHIP_CODE void addFirstByLevel(int processId) {
+    int next = head(&readyList);
+
+    while (next != -1 && processes[next].level < processes[processId].level) {
+        next = nextInQueue(next);
+    }
+    insertBefore(&readyList, next, processId);
+}
+
+/* a process that blocked before using up a quantum of its level moves up
+ * a level, and starts a new quantum */
+static ONCHIP_CODE void rewardBlocking(int processId) {
+    ProcessDescriptor* process = &processes[processId];
+
+    if (process->level > 0 && process->burst < QUANTUM(process->level)) {
+        process->level--;
+        levelStats[process->level].promotions++;
+    }
+    process->slice = 0;
+    process->burst = 0;
+}
+
+/* charge a clock tick to the running process; returns 1 at the end of its
+ * quantum, after moving it down a level */
+static ONCHIP_CODE int chargeTick(int processId) {
+    ProcessDescriptor* process = &processes[processId];
+
+    levelStats[process->level].ticks++;
+    if (process->burst < 0xffff) {
+        process->burst++;
+    }
+    if (++process->slice < QUANTUM(process->level)) {
+        return 0;
+    }
+    process->slice = 0;
+    if (process->level < MLFQ_LEVELS - 1) {
+        process->level++;
+        levelStats[process->level].demotions++;
+    }
+    return 1;
+}
+
+/* move every process back to the top level, so that none starves; the
+ * ready list stays ordered */
+static ONCHIP_CODE void ageProcesses() {
+    int i;
+
+    for (i = 0; i < nextProcessId; i++) {
+        processes[i].level = 0;
+        processes[i].slice = 0;
+    }
+}
+
+/* put the running process back in the ready list if its quantum is over
+ * or if a process of a better level is ready */
+static ONCHIP_CODE void scheduleByLevel(int quantumOver) {
+    int pid = head(&readyList);
+
+    if (pid == -1 || !processes[pid].preemptible) {
+        return;
+    }
+    int next = nextInQueue(pid);
+    if (quantumOver || (next != -1 && processes[next].level < processes[pid].level)) {
+        addByLevel(-1, removeHead(&readyList));
+    }
+}
+#endif
+
+/* make a blocked process ready. Under MLFQ_SCHEDULING it goes behind the
+ * ready processes of its level or a better one, but never ahead of the
+ * running process: the clock preempts it at the next tick if needed. */
+static ONCHIP_CODE void wakeUp(int processId) {
+    if (processId == -1) {
+        return;
+    }
+#ifdef MLFQ_SCHEDULING
+    rewardBlocking(processId);
+    addByLevel(head(&readyList), processId);
+#else
+    addLast(&readyList, processId);
+#endif
+}
+
+/* make a blocked process ready and run it next. Under MLFQ_SCHEDULING it
+ * only goes first among the processes of its level: ready processes of a
+ * better level still run before it. */
+static ONCHIP_CODE void wakeUpFirst(int processId) {
+#ifdef MLFQ_SCHEDULING
+    rewardBlocking(processId);
+    addFirstByLevel(processId);
+#else
+    addFirst(&readyList, processId);
+#endif
+}
+
+/*************** Functions for timer heap manipulation **********/
+
+/* checks if timer a expires before timer b (wrap-around safe) */
+static int timerBefore(int a, int b) {
+    return (int)(timers[a].expiry - timers[b].expiry) < 0;
+}
+
+static void timerHeapSet(int index, int timerId) {
+    timerHeap[index] = timerId;
+    timers[timerId].heapIndex = index;
+}
+
+/* move a timer up the heap until its parent expires before it */
+static void timerSiftUp(int index) {
+    int timerId = timerHeap[index];
+
+    while (index > 0) {
+        int parent = (index - 1) / 2;
+        if (!timerBefore(timerId, timerHeap[parent])) {
+            break;
+        }
+        timerHeapSet(index, timerHeap[parent]);
+        index = parent;
+    }
+    timerHeapSet(index, timerId);
+}
+
+/* move a timer down the heap until both children expire after it */
+static void timerSiftDown(int index) {
+    int timerId = timerHeap[index];
+
+    while (1) {
+        int child = 2 * index + 1;
+        if (child >= timerHeapSize) {
+            break;
+        }
+        if (child + 1 < timerHeapSize && timerBefore(timerHeap[child + 1], timerHeap[child])) {
+            child++;
+        }
+        if (!timerBefore(timerHeap[child], timerId)) {
+            break;
+        }
+        timerHeapSet(index, timerHeap[child]);
+        index = child;
+    }
+    timerHeapSet(index, timerId);
+}
+
+static void timerHeapInsert(int timerId) {
+    timerHeapSet(timerHeapSize, timerId);
+    timerSiftUp(timerHeapSize++);
+}
+
+/* remove an armed timer from anywhere in the heap in O(log n) */
+static void timerHeapRemove(int timerId) {
+    int index = timers[timerId].heapIndex;
+    int last = timerHeap[--timerHeapSize];
+
+    timers[timerId].heapIndex = -1;
+    if (index == timerHeapSize) {
+        return;
+    }
+    timerHeapSet(index, last);
+    if (index > 0 && timerBefore(last, timerHeap[(index - 1) / 2])) {
+        timerSiftUp(index);
+    }
+    else {
+        timerSiftDown(index);
+    }
+}
+
+/* run the callbacks of all expired timers; called from the clock
+ * process with interrupts masked */
+static void fireTimers() {
+    while (timerHeapSize > 0 && (int)(timers[timerHeap[0]].expiry - clockTicks) <= 0) {
+        int timerId = timerHeap[0];
+        timerHeapRemove(timerId);
+        /* re-arm before the callback so that it may cancel itself */
+        if (timers[timerId].periodic) {
+            timers[timerId].expiry += timers[timerId].period;
+            timerHeapInsert(timerId);
+        }
+        timers[timerId].callback(timers[timerId].arg);
+    }
+}
+
+/***********************************************************
+ ***********************************************************
+                    Kernel functions
+                    ************************************************************
+                    *
+                    * **********************************************************/
+
+void createStaticProcess(void (*f)(), unsigned int* stack, int stackSize) {
+    if (nextProcessId == MAX_PROC){
+        ERR("Maximum number of processes reached!");
+        exit(1);
+    }
+    processHandles[nextProcessId] = newProcess(f, stack, stackSize);
+    processes[nextProcessId].nesting = 0;
+    processes[nextProcessId].preemptible = DEFAULT_PREEMPTIBLE;
+    processes[nextProcessId].interrupt = -1;
+#ifdef MLFQ_SCHEDULING
+    processes[nextProcessId].level = 0;
+#endif
+
+    wakeUp(nextProcessId);
+    nextProcessId++;
+}
+
+#ifndef KERNEL_NO_HEAP
+void createProcess (void (*f)(), int stackSize) {
+    unsigned int* stack = malloc(stackSize);
+    if (stack==NULL) {
+        ERR("Could not allocate stack. Exiting...");
+        exit(1);
+    }
+    createStaticProcess(f, stack, stackSize);
+}
+#endif
+
+static ONCHIP_CODE void checkAndTransfer() {
+    if(isEmpty(&readyList)) {
+        transfer(idle);
+    }
+    else {
+        Process process = processHandles[head(&readyList)];
+        transfer(process);
+    }
+}
+
+/* runs the pending tasklets on the tasklet stack and comes back to
+ * caller; must be called with interrupts masked */
+static void runTasklets(Process caller) {
+    if (taskletPending == 0 || tasklet == NULL) {
+        return;
+    }
+    taskletCaller = caller;
+    transfer(tasklet);
+}
+
+static void taskletFunc() {
+    int i;
+
+    maskInterrupts();
+
+    while(1) {
+        /* rescan from the highest priority after every handler, since
+         * a handler may post other tasklets */
+        while (taskletPending != 0) {
+            for (i = 0; i < nextTaskletId; i++) {
+                int id = taskletOrder[i];
+                if (taskletPending & (1u << id)) {
+                    taskletPending &= ~(1u << id);
+                    tasklets[id].handler(tasklets[id].arg);
+                    break;
+                }
+            }
+        }
+        transfer(taskletCaller);
+    }
+}
+
+static void idleFunc() {
+    unsigned int hookTick = clockTicks;
+    unsigned int last, now;
+    int hook;
+
+    allowInterrupts();
+    last = timestamp();
+
+    while(1) {
+        int worked = 0;
+
+        /* count the whole pass as idle, checks included, unless an
+         * interrupt stretched it */
+        now = timestamp();
+        if (now - last < IDLE_LOOP_CYCLES) {
+            idleCycles += now - last;
+        }
+        last = now;
+
+        /* tasklets posted by interrupt handlers */
+        if (taskletPending != 0) {
+            irqState state = kernelLock();
+            runTasklets(idle);
+            kernelUnlock(state);
+            worked = 1;
+        }
+        /* processes woken up by interrupt handlers (semPost) */
+        if (!isEmpty(&readyList)) {
+            irqState state = kernelLock();
+            checkAndTransfer();
+            kernelUnlock(state);
+            worked = 1;
+        }
+        /* the hooks once per tick, so that most passes only check for
+         * work; the time spent in hooks counts as busy */
+        else if (idleHookCount > 0 && hookTick != clockTicks) {
+            hookTick = clockTicks;
+            for (hook = 0; hook < idleHookCount && isEmpty(&readyList); hook++) {
+                idleHooks[hook]();
+            }
+            worked = 1;
+        }
+
+        /* the time spent working counts as busy */
+        if (worked) {
+            last = timestamp();
+        }
+    }
+}
+
+/* close one second of load history; called by the clock process */
+static void sampleLoad() {
+    static unsigned int lastIdle = 0;
+    static unsigned int lastStamp = 0;
+    unsigned int idleNow = idleCycles;
+    unsigned int stamp = timestamp();
+    unsigned int total = stamp - lastStamp;
+    unsigned int idleDelta = idleNow - lastIdle;
+
+    if (idleDelta > total) {
+        idleDelta = total;
+    }
+    loadHistory[loadIndex] = total < 1000 ? 0 : (total - idleDelta) / (total / 1000);
+    loadIndex = (loadIndex + 1) % LOAD_HISTORY;
+    if (loadSamples < LOAD_HISTORY) {
+        loadSamples++;
+    }
+
+    lastIdle = idleNow;
+    lastStamp = stamp;
+}
+
+static ONCHIP_CODE void clockHandler() {
+#ifdef MLFQ_SCHEDULING
+    int quantumOver;
+#else
+    static int counter = TIME_SLICE;
+#endif
+    size_t i;
+
+    DPRINT("Starting clock process");
+
+    maskInterrupts();
+
+    init_clock();
+
+    while(1) {
+        if(isEmpty(&readyList)) {
+            iotransfer(idle, 0);
+        }
+        else {
+            iotransfer(processHandles[head(&readyList)], 0);
+        }
+        CALL_START();
+        /* idle may have been interrupted with processes ready, woken by an
+         * interrupt before it transferred to them: charge nobody then */
+        int interrupted = head(&readyList);
+        if(interrupted != -1 && processHandles[interrupted] != clockInterrupted) {
+            interrupted = -1;
+        }
+
+        clockTicks++;
+#ifdef MLFQ_SCHEDULING
+        /* the running process moves once the others are woken up */
+        quantumOver = interrupted != -1 && chargeTick(interrupted);
+#else
+        counter--;
+        if(counter == 0) {
+            counter = TIME_SLICE;
+            /* the others keep running until they block or yield */
+            if(!isEmpty(&readyList) && processes[head(&readyList)].preemptible) {
+                addLast(&readyList, removeHead(&readyList));
+            }
+        }
+#endif
+
+        /* expired processes may be anywhere in their queue */
+        int pid = head(&sleepingList);
+        while(pid != -1) {
+            int npid = nextInQueue(pid);
+            if(--processes[pid].time_ct <= 0) {
+                wakeUp(removeElement(&sleepingList, pid));
+            }
+            pid = npid;
+        }
+
+        for(i = 0 ; i < nextMonitorId ; i++) {
+            int pid = head(&(monitors[i].timedWaitList));
+            while(pid != -1) {
+                int npid = nextInQueue(pid);
+                if(--processes[pid].time_ct <= 0) {
+                    removeElement(&(monitors[i].timedWaitList), pid);
+                    if (monitors[i].takenBy != -1) {
+                        addLast(&(monitors[i].entryList), pid);
+                    }
+                    else {
+                        monitors[i].takenBy = pid;
+                        monitors[i].timesTaken++;
+                        wakeUp(pid);
+                    }
+                }
+                pid = npid;
+            }
+        }
+
+        for(i = 0 ; i < nextSemaphoreId ; i++) {
+            int pid = head(&(semaphores[i].waitList));
+            while(pid != -1) {
+                int npid = nextInQueue(pid);
+                /* untimed waiters have a negative time_ct */
+                if(processes[pid].time_ct > 0 && --processes[pid].time_ct == 0) {
+                    wakeUp(removeElement(&(semaphores[i].waitList), pid));
+                }
+                pid = npid;
+            }
+        }
+
+        if(clockTicks % TICKS_PER_SECOND == 0) {
+            sampleLoad();
+        }
+
+        fireTimers();
+        runTasklets(clk);
+
+        /* the idle process may never run under load */
+        logFlushBytes(LOG_TICK_BYTES);
+
+#ifdef MLFQ_SCHEDULING
+        if(clockTicks % MLFQ_AGING_TICKS == 0) {
+            ageProcesses();
+        }
+        scheduleByLevel(quantumOver);
+#endif
+        CALL_END(CALL_TICK, head(&readyList) != interrupted);
+    }
+}
+
+void start() {
+    LedInit();
+    DPRINT("Starting kernel...");
+
+    init_timestamp();
+
+    init_button();
+
+    idle = newProcess(idleFunc, idleStack, sizeof(idleStack));
+    clk = newProcess(clockHandler, clkStack, sizeof(clkStack));
+    tasklet = newProcess(taskletFunc, taskletStack, sizeof(taskletStack));
+
+    addIdleHook(logFlush);
+
+#define CREATE_TASK(function, stackSize) \
+    createStaticProcess(function, function##Stack, sizeof(function##Stack));
+    KERNEL_TASKS(CREATE_TASK)
+
+    transfer(clk);
+}
+
+/* gives a turn to the ready processes of the same level or a better one */
+void yield(){
+    CALL_START();
+    irqState state = kernelLock();
+    int pid = removeHead(&readyList);
+    int contended = !isEmpty(&readyList);
+#ifdef MLFQ_SCHEDULING
+    addByLevel(-1, pid);
+#else
+    addLast(&readyList, pid);
+#endif
+    CALL_BLOCKED(checkAndTransfer());
+    CALL_END(CALL_YIELD, contended);
+    kernelUnlock(state);
+}
+
+int createMonitor(){
+    if (nextMonitorId == MAX_MONITORS){
+        ERR("Maximum number of monitors reached!\n");
+        exit(1);
+    }
+    monitors[nextMonitorId].timesTaken = 0;
+    monitors[nextMonitorId].takenBy = -1;
+    initQueue(&monitors[nextMonitorId].entryList);
+    initQueue(&monitors[nextMonitorId].waitingList);
+    initQueue(&monitors[nextMonitorId].timedWaitList);
+    monitors[nextMonitorId].rw = 0;
+    monitors[nextMonitorId].readers = 0;
+    initQueue(&monitors[nextMonitorId].sharedList);
+    monitors[nextMonitorId].notified = -1;
+    return nextMonitorId++;
+}
+
+/* Reader-writer monitors let any number of readers in at once with
+ * enterShared, while enterExclusive (or enterMonitor) waits until it is
+ * alone. New readers queue behind waiting writers so writers cannot
+ * starve, and a leaving writer lets all waiting readers in before the
+ * next writer so readers cannot starve either. Conditions (wait, notify)
+ * are not available in reader-writer monitors. */
+int createRWMonitor(){
+    int monitorID = createMonitor();
+    monitors[monitorID].rw = 1;
+    return monitorID;
+}
+
+/* checks if process pid has entered monitorID as a reader */
+static int holdsShared(int pid, int monitorID) {
+    int i;
+
+    if (monitors[monitorID].readers == 0) {
+        return 0;
+    }
+    for (i = 0; i < processes[pid].nesting; i++) {
+        if (processes[pid].monitors[i] == monitorID) {
+            return 1;
+        }
+    }
+    return 0;
+}
+
+/* let every waiting reader in */
+static void admitReaders(int monitorID) {
+    while (!isEmpty(&(monitors[monitorID].sharedList))) {
+        int pid = removeHead(&(monitors[monitorID].sharedList));
+        wakeUp(pid);
+        monitors[monitorID].readers++;
+    }
+}
+
+/* hand a free monitor over to the next process waiting for it, if any;
+ * waiting readers go first when readersFirst is set. A process handed
+ * the monitor by notify is made to run next. */
+static void releaseMonitor(int monitorID, int readersFirst) {
+    if (!isEmpty(&(monitors[monitorID].sharedList))
+        && (readersFirst || isEmpty(&(monitors[monitorID].entryList)))) {
+        monitors[monitorID].timesTaken = 0;
+        monitors[monitorID].takenBy = -1;
+        admitReaders(monitorID);
+    }
+    else if (!isEmpty(&(monitors[monitorID].entryList))) {
+        int pid = removeHead(&(monitors[monitorID].entryList));
+        if (pid == monitors[monitorID].notified) {
+            monitors[monitorID].notified = -1;
+            wakeUpFirst(pid);
+        }
+        else {
+            wakeUp(pid);
+        }
+        monitors[monitorID].timesTaken = 1;
+        monitors[monitorID].takenBy = pid;
+    } else {
+        monitors[monitorID].timesTaken = 0;
+        monitors[monitorID].takenBy = -1;
+    }
+}
+
+/* checks if processes are waiting to enter monitorID */
+static int hasWaiters(int monitorID) {
+    return !isEmpty(&(monitors[monitorID].entryList)) || !isEmpty(&(monitors[monitorID].sharedList));
+}
+
+static int getCurrentMonitor(int pid) {
+    if (processes[pid].nesting == 0) {
+        return -1;
+    }
+    return processes[pid].monitors[processes[pid].nesting - 1];
+}
+
+void enterMonitor(int monitorID) {
+    CALL_START();
+    irqState state = kernelLock();
+
+    int myID = head(&readyList);
+    int contended = 0;
+
+    if (monitorID > nextMonitorId || monitorID < 0) {
+        ERRA("Monitor %d does not exist.", nextMonitorId);
+        exit(1);
+    }
+
+    /* callers take the monitor as held when this returns: halt, as for
+     * the other misuses, rather than let one run without it */
+    if (processes[myID].nesting >= NESTING_DEPTH) {
+        ERRA("Too many nested calls (more than %d).", NESTING_DEPTH);
+        exit(1);
+    }
+
+    if (holdsShared(myID, monitorID)) {
+        ERRA("Process %d cannot upgrade its shared entry to exclusive.", myID);
+        exit(1);
+    }
+
+    if ((monitors[monitorID].timesTaken > 0 && monitors[monitorID].takenBy != myID)
+        || monitors[monitorID].readers > 0) {
+        contended = 1;
+        removeHead(&readyList);
+        addLast(&(monitors[monitorID].entryList), myID);
+        CALL_BLOCKED(checkAndTransfer());
+
+        /* I am woken up by exitMonitor -- check if the monitor state
+         * is consistent */
+        if ((monitors[monitorID].timesTaken != 1) || (monitors[monitorID].takenBy != myID)) {
+            ERR("The kernel has performed an illegal operation. Please contact customer support.");
+            exit(1);
+        }
+    }
+    else {
+        monitors[monitorID].timesTaken++;
+        monitors[monitorID].takenBy = myID;
+    }
+
+    /* push the new call onto the call stack */
+    processes[myID].monitors[processes[myID].nesting++] = monitorID;
+    CALL_END(CALL_ENTER_MONITOR, contended);
+    kernelUnlock(state);
+}
+
+void exitMonitor() {
+    CALL_START();
+    irqState state = kernelLock();
+
+    int myID = head(&readyList);
+    int myMonitor = getCurrentMonitor(myID);
+    int contended = 0;
+
+
+    if (myMonitor < 0) {
+        ERRA("Process %d called exitMonitor outside of a monitor.", myID);
+        exit(1);
+    }
+
+    /* go backwards in the stack of called monitors */
+    processes[myID].nesting--;
+
+    if (monitors[myMonitor].rw && monitors[myMonitor].takenBy != myID) {
+        /* a reader leaves; the last one lets a writer in */
+        if (--monitors[myMonitor].readers == 0) {
+            contended = hasWaiters(myMonitor);
+            releaseMonitor(myMonitor, 0);
+        }
+    }
+    else if (--monitors[myMonitor].timesTaken == 0) {
+        /* see if someone is waiting, and if yes, let the next process
+         * in */
+        contended = hasWaiters(myMonitor);
+        releaseMonitor(myMonitor, 1);
+    }
+
+    /* a notified process handed the monitor runs first */
+    if (head(&readyList) != myID) {
+        CALL_BLOCKED(checkAndTransfer());
+    }
+    CALL_END(CALL_EXIT_MONITOR, contended);
+    kernelUnlock(state);
+}
+
+void wait() {
+    CALL_START();
+    irqState state = kernelLock();
+    int myID = head(&readyList);
+    int myMonitor = getCurrentMonitor(myID);
+    int myTaken;
+    int contended;
+
+    if (myMonitor < 0) {
+        ERRA("Process %d called wait outside of a monitor.", myID);
+        exit(1);
+    }
+
+    if (monitors[myMonitor].rw) {
+        ERRA("Process %d called wait in a reader-writer monitor.", myID);
+        exit(1);
+    }
+
+    removeHead(&readyList);
+    addLast(&monitors[myMonitor].waitingList, myID);
+
+    /* save timesTaken so we can restore it later */
+    myTaken = monitors[myMonitor].timesTaken;
+
+    /* let the next process in, if any */
+    contended = hasWaiters(myMonitor);
+    releaseMonitor(myMonitor, 1);
+    CALL_BLOCKED(checkAndTransfer());
+
+    /* I am woken up by exitMonitor -- check if the monitor state is
+     * consistent */
+    if ((monitors[myMonitor].timesTaken != 1) || (monitors[myMonitor].takenBy != myID)) {
+        ERR("The kernel has performed an illegal operation. Please contact customer support.");
+        exit(1);
+    }
+
+    /* we're back, restore timesTaken */
+    monitors[myMonitor].timesTaken = myTaken;
+    CALL_END(CALL_WAIT, contended);
+    kernelUnlock(state);
+}
+
+void notify() {
+    CALL_START();
+    irqState state = kernelLock();
+
+    int myID = head(&readyList);
+    int myMonitor = getCurrentMonitor(myID);
+
+    if (myMonitor < 0) {
+        ERRA("Process %d called notify outside of a monitor.", myID);
+        exit(1);
+    }
+
+    if (monitors[myMonitor].rw) {
+        ERRA("Process %d called notify in a reader-writer monitor.", myID);
+        exit(1);
+    }
+
+    int contended = !isEmpty(&(monitors[myMonitor].timedWaitList))
+        || !isEmpty(&(monitors[myMonitor].waitingList));
+
+    int pid = removeHead(&monitors[myMonitor].timedWaitList);
+    if (pid == -1) {
+        pid = removeHead(&monitors[myMonitor].waitingList);
+    }
+    if (pid != -1) {
+#ifdef MONITOR_HANDOFF
+        /* skip the processes waiting to enter; releaseMonitor runs it */
+        addFirst(&monitors[myMonitor].entryList, pid);
+        monitors[myMonitor].notified = pid;
+#else
+        addLast(&monitors[myMonitor].entryList, pid);
+#endif
+    }
+    CALL_END(CALL_NOTIFY, contended);
+    kernelUnlock(state);
+}
+
+void notifyAll() {
+    CALL_START();
+    irqState state = kernelLock();
+
+    int myID = head(&readyList);
+    int myMonitor = getCurrentMonitor(myID);
+
+    if (myMonitor < 0) {
+        ERRA("Process %d called notify outside of a monitor.", myID);
+        exit(1);
+    }
+
+    if (monitors[myMonitor].rw) {
+        ERRA("Process %d called notifyAll in a reader-writer monitor.", myID);
+        exit(1);
+    }
+
+    int contended = !isEmpty(&(monitors[myMonitor].timedWaitList))
+        || !isEmpty(&(monitors[myMonitor].waitingList));
+
+    /* timed waiters first, as in notify; their time_ct stays positive */
+    spliceLast(&monitors[myMonitor].entryList, &monitors[myMonitor].timedWaitList);
+    spliceLast(&monitors[myMonitor].entryList, &monitors[myMonitor].waitingList);
+
+    CALL_END(CALL_NOTIFY_ALL, contended);
+    kernelUnlock(state);
+}
+
+int timedWait(int time) {
+    CALL_START();
+    irqState state = kernelLock();
+
+    if (time == 0) { //If time is 0 just wait
+        wait();
+        kernelUnlock(state);
+        return 1;
+    }
+
+    int myID = removeHead(&readyList);
+    int myMonitor = getCurrentMonitor(myID);
+
+    if(myMonitor < 0) {
+        ERRA("Process %d called timedWait outside of a monitor.", myID);
+        exit(1);
+    }
+
+    if (monitors[myMonitor].rw) {
+        ERRA("Process %d called timedWait in a reader-writer monitor.", myID);
+        exit(1);
+    }
+
+    processes[myID].time_ct = time;
+
+    int contended = hasWaiters(myMonitor);
+    releaseMonitor(myMonitor, 1);
+
+    addLast(&monitors[myMonitor].timedWaitList, myID);
+
+    CALL_BLOCKED(checkAndTransfer());
+
+    /* read the remaining time before anything else can run */
+    int notified = processes[head(&readyList)].time_ct > 0;
+
+    CALL_END(CALL_TIMED_WAIT, contended);
+    kernelUnlock(state);
+
+    return notified;
+}
+
+void sleep(int msec){
+    CALL_START();
+    irqState state = kernelLock();
+
+    int myID = removeHead(&readyList);
+    int contended = !isEmpty(&readyList);
+
+    processes[myID].time_ct = msec; //Update the wait time for this process
+
+    addLast(&sleepingList, myID); // Put it in the sleeping list
+
+    CALL_BLOCKED(checkAndTransfer()); //Transfer control
+
+    CALL_END(CALL_SLEEP, contended);
+    kernelUnlock(state);
+}
+
+void waitInterrupt(int per){
+    if(per < 0 || per >= INTERRUPT_COUNT){
+        ERRA("Waiting for invalid interrupt %d!\n", per);
+        exit(1);
+    }
+
+    CALL_START();
+    irqState state = kernelLock();
+
+    int pid = removeHead(&readyList);
+    int contended = per != 0 && !isEmpty(&readyList);
+    Process p;
+
+    if(per != 0) {
+        //On ne peut avoir que clk qui attend sur les interruptions du timer
+        if(isEmpty(&readyList)) {
+            p = idle;
+        }
+        else {
+            p = processHandles[head(&readyList)];
+        }
+        processes[pid].interrupt = per;
+        CALL_BLOCKED(iotransfer(p, per));
+        processes[pid].interrupt = -1;
+        wakeUpFirst(pid);
+        /* a process of a better level became ready meanwhile */
+        if (head(&readyList) != pid) {
+            CALL_BLOCKED(checkAndTransfer());
+        }
+    }
+    CALL_END(CALL_WAIT_INTERRUPT, contended);
+    kernelUnlock(state);
+}
+
+/* Timer callbacks run in the clock process with interrupts masked: they
+ * must be short and must not block, but may start or cancel timers. */
+int createTimer(void (*callback)(void*), void* arg, int ticks, int periodic) {
+    if (nextTimerId == MAX_TIMERS) {
+        ERR("Maximum number of timers reached!");
+        exit(1);
+    }
+    if (callback == NULL || ticks <= 0) {
+        ERRA("Invalid timer period %d.", ticks);
+        exit(1);
+    }
+    timers[nextTimerId].callback = callback;
+    timers[nextTimerId].arg = arg;
+    timers[nextTimerId].period = ticks;
+    timers[nextTimerId].periodic = periodic;
+    timers[nextTimerId].heapIndex = -1;
+    return nextTimerId++;
+}
+
+void startTimer(int timerID) {
+    if (timerID >= nextTimerId || timerID < 0) {
+        ERRA("Timer %d does not exist.", timerID);
+        exit(1);
+    }
+
+    irqState state = kernelLock();
+
+    /* restarting an armed timer pushes its expiry back */
+    if (timers[timerID].heapIndex != -1) {
+        timerHeapRemove(timerID);
+    }
+    timers[timerID].expiry = clockTicks + timers[timerID].period;
+    timerHeapInsert(timerID);
+
+    kernelUnlock(state);
+}
+
+void cancelTimer(int timerID) {
+    if (timerID >= nextTimerId || timerID < 0) {
+        ERRA("Timer %d does not exist.", timerID);
+        exit(1);
+    }
+
+    irqState state = kernelLock();
+
+    if (timers[timerID].heapIndex != -1) {
+        timerHeapRemove(timerID);
+    }
+
+    kernelUnlock(state);
+}
+
+/* Tasklets are short run-to-completion handlers that share one stack and
+ * run with interrupts masked; like timer callbacks they must not block. */
+int createTasklet(void (*handler)(void*), void* arg, int priority) {
+    int i;
+
+    if (nextTaskletId == MAX_TASKLETS) {
+        ERR("Maximum number of tasklets reached!");
+        exit(1);
+    }
+    if (handler == NULL) {
+        ERR("Invalid tasklet handler.");
+        exit(1);
+    }
+
+    irqState state = kernelLock();
+
+    tasklets[nextTaskletId].handler = handler;
+    tasklets[nextTaskletId].arg = arg;
+    tasklets[nextTaskletId].priority = priority;
+
+    /* insert into the priority order, after tasklets of equal priority */
+    for (i = nextTaskletId; i > 0 && tasklets[taskletOrder[i - 1]].priority > priority; i--) {
+        taskletOrder[i] = taskletOrder[i - 1];
+    }
+    taskletOrder[i] = nextTaskletId;
+
+    kernelUnlock(state);
+    return nextTaskletId++;
+}
+
+/* Marks a tasklet as pending; posting it again before it runs has no
+ * further effect. Called with interrupts allowed (from a process), the
+ * pending tasklets run before postTasklet returns; called with interrupts
+ * masked (from an interrupt handler, a timer callback or a tasklet), they
+ * run at the next tick or when the system goes idle. */
+void postTasklet(int taskletID) {
+    if (taskletID >= nextTaskletId || taskletID < 0) {
+        ERRA("Tasklet %d does not exist.", taskletID);
+        exit(1);
+    }
+
+    irqState state = kernelLock();
+    taskletPending |= 1u << taskletID;
+    if (irqEnabled(state)) {
+        runTasklets(isEmpty(&readyList) ? idle : processHandles[head(&readyList)]);
+    }
+    kernelUnlock(state);
+}
+
+/* Channels move pool-allocated buffers between processes by pointer:
+ * the sender gives up the buffer in chanSend and the receiver owns it
+ * after chanRecv, until it hands it back with chanRelease. */
+int createChannel(int poolID, int depth) {
+    if (nextChannelId == MAX_CHANNELS) {
+        ERR("Maximum number of channels reached!");
+        exit(1);
+    }
+    if (depth <= 0 || depth > MAX_CHANNEL_DEPTH) {
+        ERRA("Invalid channel depth %d.", depth);
+        exit(1);
+    }
+    channels[nextChannelId].first = 0;
+    channels[nextChannelId].count = 0;
+    channels[nextChannelId].depth = depth;
+    channels[nextChannelId].pool = poolID;
+    initQueue(&channels[nextChannelId].receiveList);
+    initQueue(&channels[nextChannelId].sendList);
+    return nextChannelId++;
+}
+
+static void checkChannel(int channelID) {
+    if (channelID >= nextChannelId || channelID < 0) {
+        ERRA("Channel %d does not exist.", channelID);
+        exit(1);
+    }
+}
+
+void chanSend(int channelID, void* buffer) {
+    checkChannel(channelID);
+
+    irqState state = kernelLock();
+    ChannelDescriptor* channel = &channels[channelID];
+
+    while (channel->count == channel->depth) {
+        int myID = removeHead(&readyList);
+        addLast(&channel->sendList, myID);
+        checkAndTransfer();
+    }
+
+    channel->ring[(channel->first + channel->count) % channel->depth] = buffer;
+    channel->count++;
+
+    /* wake up one receiver; it takes the buffer when it runs */
+    wakeUp(removeHead(&channel->receiveList));
+
+    kernelUnlock(state);
+}
+
+void* chanRecv(int channelID) {
+    void* buffer;
+
+    checkChannel(channelID);
+
+    irqState state = kernelLock();
+    ChannelDescriptor* channel = &channels[channelID];
+
+    while (channel->count == 0) {
+        int myID = removeHead(&readyList);
+        addLast(&channel->receiveList, myID);
+        checkAndTransfer();
+    }
+
+    buffer = channel->ring[channel->first];
+    channel->first = (channel->first + 1) % channel->depth;
+    channel->count--;
+
+    wakeUp(removeHead(&channel->sendList));
+
+    kernelUnlock(state);
+    return buffer;
+}
+
+void* chanAlloc(int channelID) {
+    checkChannel(channelID);
+    return poolAlloc(channels[channelID].pool);
+}
+
+void chanRelease(int channelID, void* buffer) {
+    checkChannel(channelID);
+    poolFree(channels[channelID].pool, buffer);
+}
+
+void enterExclusive(int monitorID) {
+    enterMonitor(monitorID);
+}
+
+void enterShared(int monitorID) {
+    irqState state = kernelLock();
+
+    int myID = head(&readyList);
+
+    if (monitorID >= nextMonitorId || monitorID < 0 || !monitors[monitorID].rw) {
+        ERRA("Reader-writer monitor %d does not exist.", monitorID);
+        exit(1);
+    }
+
+    if (processes[myID].nesting >= NESTING_DEPTH) {
+        ERRA("Too many nested calls (more than %d).", NESTING_DEPTH);
+        exit(1);
+    }
+
+    if (monitors[monitorID].takenBy == myID) {
+        /* the writer reads too: count it as a nested exclusive entry */
+        monitors[monitorID].timesTaken++;
+    }
+    else if (holdsShared(myID, monitorID)) {
+        /* nested shared entry; never queue behind writers here, since
+         * they are waiting for us */
+        monitors[monitorID].readers++;
+    }
+    else if (monitors[monitorID].takenBy != -1 || !isEmpty(&(monitors[monitorID].entryList))) {
+        removeHead(&readyList);
+        addLast(&(monitors[monitorID].sharedList), myID);
+        checkAndTransfer();
+
+        /* I am let in by a leaving writer, which counted me as a reader */
+        if (monitors[monitorID].takenBy != -1 || monitors[monitorID].readers == 0) {
+            ERR("The kernel has performed an illegal operation. Please contact customer support.");
+            exit(1);
+        }
+    }
+    else {
+        monitors[monitorID].readers++;
+    }
+
+    processes[myID].monitors[processes[myID].nesting++] = monitorID;
+    kernelUnlock(state);
+}
+
+/* Semaphores and mutexes are lighter than monitors: they keep no nesting
+ * stack and, when they do not have to block, only mask interrupts around
+ * a counter update. */
+int createSemaphore(int initial) {
+    if (nextSemaphoreId == MAX_SEMAPHORES) {
+        ERR("Maximum number of semaphores reached!");
+        exit(1);
+    }
+    if (initial < 0) {
+        ERRA("Invalid semaphore count %d.", initial);
+        exit(1);
+    }
+    semaphores[nextSemaphoreId].count = initial;
+    initQueue(&semaphores[nextSemaphoreId].waitList);
+    return nextSemaphoreId++;
+}
+
+static void checkSemaphore(int semaphoreID) {
+    if (semaphoreID >= nextSemaphoreId || semaphoreID < 0) {
+        ERRA("Semaphore %d does not exist.", semaphoreID);
+        exit(1);
+    }
+}
+
+/* returns 1 once the semaphore is taken, 0 if msec ticks went by first;
+ * msec 0 waits forever */
+int semTimedWait(int semaphoreID, int msec) {
+    int taken = 1;
+
+    checkSemaphore(semaphoreID);
+
+    irqState state = kernelLock();
+    SemaphoreDescriptor* semaphore = &semaphores[semaphoreID];
+
+    if (semaphore->count > 0) {
+        semaphore->count--;
+    }
+    else {
+        /* semPost hands its unit over directly instead of counting it */
+        int myID = removeHead(&readyList);
+        processes[myID].time_ct = msec > 0 ? msec : -1;
+        addLast(&semaphore->waitList, myID);
+        checkAndTransfer();
+        taken = processes[myID].time_ct != 0;
+    }
+
+    kernelUnlock(state);
+    return taken;
+}
+
+void semWait(int semaphoreID) {
+    semTimedWait(semaphoreID, 0);
+}
+
+/* returns 1 if a unit was taken, 0 instead of blocking */
+int semTryWait(int semaphoreID) {
+    int taken = 0;
+
+    checkSemaphore(semaphoreID);
+
+    irqState state = kernelLock();
+    if (semaphores[semaphoreID].count > 0) {
+        semaphores[semaphoreID].count--;
+        taken = 1;
+    }
+    kernelUnlock(state);
+    return taken;
+}
+
+/* may be called from interrupt handlers */
+void semPost(int semaphoreID) {
+    checkSemaphore(semaphoreID);
+
+    irqState state = kernelLock();
+    SemaphoreDescriptor* semaphore = &semaphores[semaphoreID];
+
+    if (isEmpty(&semaphore->waitList)) {
+        semaphore->count++;
+    }
+    else {
+        wakeUp(removeHead(&semaphore->waitList));
+    }
+
+    kernelUnlock(state);
+}
+
+int createMutex() {
+    if (nextMutexId == MAX_MUTEXES) {
+        ERR("Maximum number of mutexes reached!");
+        exit(1);
+    }
+    mutexes[nextMutexId].owner = -1;
+    initQueue(&mutexes[nextMutexId].waitList);
+    return nextMutexId++;
+}
+
+/* Without an atomic instruction on the Nios II, masking interrupts around
+ * the test and the store of the owner is what claims a free mutex on one
+ * processor: no process can run in between, and it costs a status read
+ * and two writes. Only a held mutex goes through the ready list. */
+ONCHIP_CODE void mutexLock(int mutexID) {
+    MutexDescriptor* mutex = &mutexes[mutexID];
+    int myID = head(&readyList);
+
+    if ((unsigned) mutexID >= (unsigned) nextMutexId) {
+        ERRA("Mutex %d does not exist.", mutexID);
+        exit(1);
+    }
+
+    irqState state = kernelLock();
+    if (mutex->owner == -1) {
+        mutex->owner = myID;
+        kernelUnlock(state);
+        return;
+    }
+
+    if (mutex->owner == myID) {
+        ERRA("Process %d already owns mutex %d.", myID, mutexID);
+        exit(1);
+    }
+
+    /* contended: mutexUnlock makes us the owner before waking us up */
+    removeHead(&readyList);
+    addLast(&mutex->waitList, myID);
+    checkAndTransfer();
+
+    kernelUnlock(state);
+}
+
+/* Releasing needs no masking while nobody waits: a process that finds
+ * the mutex held queues itself before the owner is cleared, and then the
+ * wait list is seen here; once it is cleared, it takes the mutex instead
+ * of queueing. */
+ONCHIP_CODE void mutexUnlock(int mutexID) {
+    MutexDescriptor* mutex = &mutexes[mutexID];
+
+    if ((unsigned) mutexID >= (unsigned) nextMutexId || mutex->owner != head(&readyList)) {
+        ERRA("Process %d does not own mutex %d.", head(&readyList), mutexID);
+        exit(1);
+    }
+
+    mutex->owner = -1;
+    /* volatile, so that the list is read after the owner is cleared */
+    if (((volatile ProcessQueue*) &mutex->waitList)->head == -1) {
+        return;
+    }
+
+    /* contended: hand it over, unless a process took it in between */
+    irqState state = kernelLock();
+    if (mutex->owner == -1) {
+        mutex->owner = removeHead(&mutex->waitList);
+        wakeUp(mutex->owner);
+    }
+    kernelUnlock(state);
+}
+
+/* Idle hooks run in the idle process once per clock tick while no process
+ * is ready. They must not block, and should return quickly so that
+ * processes woken up by interrupts are not delayed. */
+void addIdleHook(void (*hook)()) {
+    if (idleHookCount == MAX_IDLE_HOOKS) {
+        ERR("Maximum number of idle hooks reached!");
+        exit(1);
+    }
+
+    irqState state = kernelLock();
+    idleHooks[idleHookCount++] = hook;
+    kernelUnlock(state);
+}
+
+/* returns the percentage of time the CPU was busy over the last seconds
+ * seconds (at most LOAD_HISTORY), or -1 before the first second is over */
+int cpuLoad(int seconds) {
+    int i, total = 0;
+
+    if (seconds < 1 || seconds > LOAD_HISTORY) {
+        ERRA("Load is only kept for 1 to %d seconds.", LOAD_HISTORY);
+        exit(1);
+    }
+
+    irqState state = kernelLock();
+
+    if (seconds > loadSamples) {
+        seconds = loadSamples;
+    }
+    for (i = 1; i <= seconds; i++) {
+        total += loadHistory[(loadIndex - i + LOAD_HISTORY) % LOAD_HISTORY];
+    }
+
+    kernelUnlock(state);
+
+    return seconds == 0 ? -1 : total / (seconds * 10);
+}
+
+/* id of the process running now, -1 for the kernel processes; also
+ * valid in interrupt handlers, where it is the interrupted process. With
+ * interrupts allowed, a running process is always at the head of the
+ * ready list, so the timer interrupt can call it in constant time. */
+int getRunningProcess() {
+    int pid = head(&readyList);
+
+    if (pid != -1 && processHandles[pid] == running) {
+        return pid;
+    }
+    return -1;
+}
+
+/* sets whether the calling process is rotated with the other ready
+ * processes every TIME_SLICE ticks */
+void setPreemptible(int preemptible) {
+    irqState state = kernelLock();
+    processes[head(&readyList)].preemptible = preemptible != 0;
+    kernelUnlock(state);
+}
+
+/* clock ticks since start(); wraps around, so compare differences */
+unsigned int getTicks() {
+    return clockTicks;
+}
+
+void getCallProfile(int call, CallProfile* profile) {
+    if (call < 0 || call >= KERNEL_CALLS) {
+        ERRA("Kernel call %d does not exist.", call);
+        exit(1);
+    }
+
+    memset(profile, 0, sizeof(CallProfile));
+#ifdef PROFILE_CALLS
+    irqState state = kernelLock();
+    *profile = callProfiles[call];
+    if (profile->count > 0) {
+        profile->avgCycles = callCycles[call] / profile->count;
+        profile->avgWaitCycles = callWaitCycles[call] / profile->count;
+    }
+    kernelUnlock(state);
+#endif
+}
+
+void resetCallProfiles() {
+#ifdef PROFILE_CALLS
+    irqState state = kernelLock();
+    memset(callProfiles, 0, sizeof(callProfiles));
+    memset(callCycles, 0, sizeof(callCycles));
+    memset(callWaitCycles, 0, sizeof(callWaitCycles));
+    kernelUnlock(state);
+#endif
+}
+
+void kernelSnapshot(KernelSnapshot* snapshot) {
+    int i;
+
+    irqState state = kernelLock();
+
+    snapshot->ticks = clockTicks;
+    snapshot->processCount = nextProcessId;
+    snapshot->monitorCount = nextMonitorId;
+    snapshot->channelCount = nextChannelId;
+    snapshot->semaphoreCount = nextSemaphoreId;
+    snapshot->mutexCount = nextMutexId;
+    snapshot->readyList = readyList.head;
+    snapshot->sleepingList = sleepingList.head;
+
+    for (i = 0; i < nextProcessId; i++) {
+        snapshot->processes[i].next = processLinks[i].next;
+        snapshot->processes[i].interrupt = processes[i].interrupt;
+        snapshot->processes[i].timeLeft = processes[i].time_ct;
+    }
+
+    for (i = 0; i < nextMonitorId; i++) {
+        snapshot->monitors[i].takenBy = monitors[i].takenBy;
+        snapshot->monitors[i].timesTaken = monitors[i].timesTaken;
+        snapshot->monitors[i].readers = monitors[i].readers;
+        snapshot->monitors[i].entryList = monitors[i].entryList.head;
+        snapshot->monitors[i].waitingList = monitors[i].waitingList.head;
+        snapshot->monitors[i].timedWaitList = monitors[i].timedWaitList.head;
+        snapshot->monitors[i].sharedList = monitors[i].sharedList.head;
+    }
+
+    for (i = 0; i < nextChannelId; i++) {
+        snapshot->channels[i].count = channels[i].count;
+        snapshot->channels[i].receiveList = channels[i].receiveList.head;
+        snapshot->channels[i].sendList = channels[i].sendList.head;
+    }
+
+    for (i = 0; i < nextSemaphoreId; i++) {
+        snapshot->semaphores[i].count = semaphores[i].count;
+        snapshot->semaphores[i].waitList = semaphores[i].waitList.head;
+    }
+
+    for (i = 0; i < nextMutexId; i++) {
+        snapshot->mutexes[i].owner = mutexes[i].owner;
+        snapshot->mutexes[i].waitList = mutexes[i].waitList.head;
+    }
+
+    kernelUnlock(state);
+}
+
+void getLevelStats(int level, LevelStats* stats) {
+    if (level < 0 || level >= MLFQ_LEVELS) {
+        ERRA("Scheduling level %d does not exist.", level);
+        exit(1);
+    }
+
+    memset(stats, 0, sizeof(LevelStats));
+#ifdef MLFQ_SCHEDULING
+    int i;
+    irqState state = kernelLock();
+    *stats = levelStats[level];
+    for (i = 0; i < nextProcessId; i++) {
+        stats->processes += processes[i].level == level;
+    }
+    kernelUnlock(state);
+#endif
+}
+
+void resetLevelStats() {
+#ifdef MLFQ_SCHEDULING
+    irqState state = kernelLock();
+    memset(levelStats, 0, sizeof(levelStats));
+    kernelUnlock(state);
+#endif
+}
+
+#ifdef KERNEL_CHECKS
+#define CHECK(condition, text, ...) \
+    if (!(condition)) { ERRA("inconsistent kernel: " text, __VA_ARGS__); errors++; }
+
+/* checks the links of a queue and marks its processes as seen */
+static int checkQueue(ProcessQueue* queue, const char* name, int index, char* seen) {
+    int errors = 0;
+    int prev = -1;
+    int pid = head(queue);
+    int length = 0;
+
+    while (pid != -1) {
+        CHECK(pid >= 0 && pid < nextProcessId, "%s %d holds process %d", name, index, pid);
+        if (pid < 0 || pid >= nextProcessId || ++length > nextProcessId) {
+            CHECK(length <= nextProcessId, "%s %d loops", name, index);
+            return errors;
+        }
+        CHECK(processLinks[pid].prev == prev, "%s %d: process %d has a bad previous link", name, index, pid);
+        CHECK(!seen[pid], "process %d is in two queues, one of them %s %d", pid, name, index);
+        seen[pid] = 1;
+        prev = pid;
+        pid = processLinks[pid].next;
+    }
+    CHECK(queue->tail == prev, "%s %d has a bad tail", name, index);
+    return errors;
+}
+
+/* checks if monitorID is in the call stack of process pid, or if pid
+ * was handed the monitor and has yet to return from enterMonitor */
+static int inMonitor(int pid, int monitorID) {
+    int i;
+
+    for (i = 0; i < processes[pid].nesting; i++) {
+        if (processes[pid].monitors[i] == monitorID) {
+            return 1;
+        }
+    }
+    for (i = head(&readyList); i != -1; i = nextInQueue(i)) {
+        if (i == pid) {
+            return 1;
+        }
+    }
+    return 0;
+}
+
+int checkKernel() {
+    char seen[MAX_PROC] = {0};
+    int errors = 0;
+    int missing = 0;
+    int i;
+
+    irqState state = kernelLock();
+
+    errors += checkQueue(&readyList, "ready list", 0, seen);
+    errors += checkQueue(&sleepingList, "sleeping list", 0, seen);
+
+    for (i = 0; i < nextMonitorId; i++) {
+        MonitorDescriptor* monitor = &monitors[i];
+
+        errors += checkQueue(&monitor->entryList, "entry list of monitor", i, seen);
+        errors += checkQueue(&monitor->waitingList, "waiting list of monitor", i, seen);
+        errors += checkQueue(&monitor->timedWaitList, "timed wait list of monitor", i, seen);
+        errors += checkQueue(&monitor->sharedList, "shared list of monitor", i, seen);
+
+        CHECK((monitor->takenBy == -1) == (monitor->timesTaken == 0),
+              "monitor %d is taken %d times by %d", i, monitor->timesTaken, monitor->takenBy);
+        CHECK(monitor->takenBy == -1 || inMonitor(monitor->takenBy, i),
+              "process %d owns monitor %d without having entered it", monitor->takenBy, i);
+        CHECK(monitor->readers == 0 || monitor->takenBy == -1,
+              "monitor %d has both readers and an owner", i);
+        /* nobody may wait for a monitor nobody holds */
+        CHECK(monitor->takenBy != -1 || monitor->readers != 0
+              || (isEmpty(&monitor->entryList) && isEmpty(&monitor->sharedList)),
+              "processes wait to enter free monitor %d", i);
+    }
+
+    for (i = 0; i < nextChannelId; i++) {
+        errors += checkQueue(&channels[i].receiveList, "receive list of channel", i, seen);
+        errors += checkQueue(&channels[i].sendList, "send list of channel", i, seen);
+    }
+
+    for (i = 0; i < nextSemaphoreId; i++) {
+        errors += checkQueue(&semaphores[i].waitList, "wait list of semaphore", i, seen);
+        CHECK(semaphores[i].count == 0 || isEmpty(&semaphores[i].waitList),
+              "processes wait for semaphore %d, which has %d units", i, semaphores[i].count);
+    }
+
+    for (i = 0; i < nextMutexId; i++) {
+        errors += checkQueue(&mutexes[i].waitList, "wait list of mutex", i, seen);
+        CHECK(mutexes[i].owner != -1 || isEmpty(&mutexes[i].waitList),
+              "processes wait for free mutex %d", i);
+    }
+
+    /* the others can only be waiting for the buttons */
+    for (i = 0; i < nextProcessId; i++) {
+        CHECK(seen[i] || processes[i].interrupt == 1, "process %d is in no queue", i);
+        missing += !seen[i];
+    }
+    CHECK(missing == interruptWaiters(1), "%d processes are lost", missing - interruptWaiters(1));
+
+    kernelUnlock(state);
+    return errors;
+}
+#else
+int checkKernel() {
+    return 0;
+}
+#endif
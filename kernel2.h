@@ -1,28 +1,184 @@
-#ifndef KERNEL2_H_
-#define KERNEL2_H_
-
-void createProcess(void (*f)(), int stackSize);
-
-void start();
-
-int createMonitor();
-
-void enterMonitor(int monitorID);
-
-void exitMonitor();
-
-void wait();
-
-int timedWait(int msec);
-
-void notify();
-
-void notifyAll();
-
-void sleep(int msec);
-
-void yield();
-
-void waitInterrupt(int per);
-
-#endif /*KERNEL2_H_*/
+#ifndef KERNEL2_H_
+#define KERNEL2_H_
+
+#include "kernel_config.h"
+
+void createProcess(void (*f)(), int stackSize);
+
+void createStaticProcess(void (*f)(), unsigned int* stack, int stackSize);
+
+void start();
+
+int createMonitor();
+
+void enterMonitor(int monitorID);
+
+void exitMonitor();
+
+int createRWMonitor();
+
+void enterShared(int monitorID);
+
+void enterExclusive(int monitorID);
+
+void wait();
+
+int timedWait(int msec);
+
+void notify();
+
+void notifyAll();
+
+void sleep(int msec);
+
+void yield();
+
+void setPreemptible(int preemptible);
+
+void waitInterrupt(int per);
+
+int createTimer(void (*callback)(void*), void* arg, int ticks, int periodic);
+
+void startTimer(int timerID);
+
+void cancelTimer(int timerID);
+
+int createTasklet(void (*handler)(void*), void* arg, int priority);
+
+void postTasklet(int taskletID);
+
+int createChannel(int poolID, int depth);
+
+void chanSend(int channelID, void* buffer);
+
+void* chanRecv(int channelID);
+
+void* chanAlloc(int channelID);
+
+void chanRelease(int channelID, void* buffer);
+
+int createSemaphore(int initial);
+
+void semWait(int semaphoreID);
+
+int semTimedWait(int semaphoreID, int msec);
+
+int semTryWait(int semaphoreID);
+
+void semPost(int semaphoreID);
+
+int createMutex();
+
+void mutexLock(int mutexID);
+
+void mutexUnlock(int mutexID);
+
+void addIdleHook(void (*hook)());
+
+int cpuLoad(int seconds);
+
+unsigned int getTicks();
+
+int getRunningProcess();
+
+/* Kernel calls profiled when compiling with -DPROFILE_CALLS */
+enum {
+    CALL_ENTER_MONITOR, /* contended: had to wait for the monitor */
+    CALL_EXIT_MONITOR, /* contended: handed the monitor to a waiter */
+    CALL_WAIT, /* contended: handed the monitor to a waiter */
+    CALL_NOTIFY, /* contended: found a waiter */
+    CALL_NOTIFY_ALL, /* contended: found a waiter */
+    CALL_TIMED_WAIT, /* contended: handed the monitor to a waiter */
+    CALL_SLEEP, /* contended: another process ran meanwhile */
+    CALL_YIELD, /* contended: another process ran meanwhile */
+    CALL_WAIT_INTERRUPT, /* contended: another process ran meanwhile */
+    CALL_TICK, /* contended: the tick switched processes */
+    KERNEL_CALLS
+};
+
+/* Cycles are the cost of the call; the time the caller spent blocked in
+ * it, while other processes ran, is counted apart as wait cycles */
+typedef struct {
+    unsigned int count;
+    unsigned int contended;
+    unsigned int minCycles;
+    unsigned int avgCycles;
+    unsigned int maxCycles;
+    unsigned int avgWaitCycles;
+    unsigned int maxWaitCycles;
+} CallProfile;
+
+/* Function that copies the counters of a kernel call; they are all 0
+ * without PROFILE_CALLS. */
+void getCallProfile(int call, CallProfile* profile);
+
+/* Function that clears the counters of all kernel calls. */
+void resetCallProfiles();
+
+/* Counters of a level of the multilevel feedback scheduler */
+typedef struct {
+    unsigned int processes; /* processes at the level now */
+    unsigned int ticks; /* clock ticks run at the level */
+    unsigned int promotions; /* processes moved up to the level */
+    unsigned int demotions; /* processes moved down to the level */
+} LevelStats;
+
+/* Function that copies the counters of a scheduling level, from 0 to
+ * MLFQ_LEVELS - 1; they are all 0 without MLFQ_SCHEDULING. */
+void getLevelStats(int level, LevelStats* stats);
+
+/* Function that clears the counters of all scheduling levels. */
+void resetLevelStats();
+
+/* Copy of the kernel tables taken by kernelSnapshot. Each queue is given
+ * by its first process, and processes[pid].next is the process after pid
+ * in its queue; -1 ends a queue. */
+typedef struct {
+    unsigned int ticks;
+    short processCount;
+    short monitorCount;
+    short channelCount;
+    short semaphoreCount;
+    short mutexCount;
+    short readyList; /* the process that took the snapshot first */
+    short sleepingList;
+    struct {
+        short next;
+        signed char interrupt; /* interrupt waited for, or -1 */
+        int timeLeft; /* ticks left of a sleep or timed wait */
+    } processes[MAX_PROC];
+    struct {
+        short takenBy; /* -1 when free */
+        unsigned char timesTaken;
+        unsigned char readers;
+        short entryList;
+        short waitingList;
+        short timedWaitList;
+        short sharedList;
+    } monitors[MAX_MONITORS];
+    struct {
+        short count; /* buffers in transit */
+        short receiveList;
+        short sendList;
+    } channels[MAX_CHANNELS];
+    struct {
+        int count;
+        short waitList;
+    } semaphores[MAX_SEMAPHORES];
+    struct {
+        short owner; /* -1 when free */
+        short waitList;
+    } mutexes[MAX_MUTEXES];
+} KernelSnapshot;
+
+/* Function that copies the kernel tables at once, with interrupts masked
+ * only for the copy. */
+void kernelSnapshot(KernelSnapshot* snapshot);
+
+/* Function that checks the kernel tables when compiled with
+ * -DKERNEL_CHECKS, reporting each inconsistency on stderr. Call it with
+ * interrupts allowed and outside kernel calls. Returns the number of
+ * inconsistencies found. */
+int checkKernel();
+
+#endif /*KERNEL2_H_*/
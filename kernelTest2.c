@@ -4,15 +4,18 @@
 #include "interrupt.h"
 #include "altera_avalon_pio_regs.h"
 #include "kernel2.h"
+#include "log.h"
+#include "display.h"
+#include "input.h"
 
-#define STACK_SIZE10000
-#define INTERVAL100
-#define FREEZE_FOR3000
+#define STACK_SIZE	10000
+#define INTERVAL	100
+#define FREEZE_FOR	3000
 
-#define RESET0x1111
-#define START0x2222
-#define STOP0x3333
-#define TIMEOUT0xFFFF
+#define RESET	0x1111
+#define START	0x2222
+#define STOP	0x3333
+#define TIMEOUT	0xFFFF
 
 /*********************** Buffer implemented using monitors *********************/
 typedef struct {
@@ -79,16 +82,7 @@ int reset = 0;
 int displayOn = 1;
 int started = 0;
 
-/* arrays used to convert digits to their LCD representations */
-int digitCodes[] = {0x3E223E00, 0x203E2400, 0x2E2A3A00, 0x3E2A2A00, 0x3E080E00,
-                    0x3A2A2E00, 0x3A2A3E00, 0x3E020200, 0x3E2A3E00, 0x3E2A2E00, 0};
-int lcdZones[] = {LED_0_BASE, LED_1_BASE, LED_2_BASE};
-
-/* displays digit "no" in LCD zone "zone" */
-void displayDigit(int zone, int no) {
-    IOWR_ALTERA_AVALON_PIO_DATA(lcdZones[zone], digitCodes[no]);
-}
-
+/* the display driver only writes the digits that changed */
 void displayNumber(int no) {
     displayDigit(2, no % 10);
     displayDigit(1, (no / 10) % 10);
@@ -96,36 +90,31 @@ void displayNumber(int no) {
 }
 
 void producer(){
-    int temp;
+    InputEvent event;
 
-    printf("Producer starting...\n");
+    klog("Producer starting...\n");
 
     while(1) {
-        waitInterrupt(1);
-        temp = edge_capture;
-        if (temp != 0) {
+        inputWait(&event);
+        if (!event.pressed)
+            continue;
 
-            /* check button 0 */
-            if (temp%2==1) {
-                printf("Reset.\n");
+        switch (event.key) {
+            case 0:
+                klog("Reset at %u.\n", event.time);
                 put(&b0, RESET);
-            }
-
-            /* check button 1 */
-            temp = temp >> 1;
-            if (temp%2==1) {
-                printf("Start/Freeze.\n");
+                break;
+            case 1:
+                klog("Start/Freeze at %u.\n", event.time);
                 put(&b0, START);
-            }
-
-            /* check button 2 */
-            temp = temp >> 1;
-            if (temp%2==1) {
-                printf("Stop.\n");
+                break;
+            case 2:
+                klog("Stop at %u.\n", event.time);
                 put(&b0, STOP);
-            }
-
-            /* button 3 ignored */
+                break;
+            default:
+                /* button 3 and the switches ignored */
+                break;
         }
     }
 }
@@ -134,7 +123,7 @@ void producer(){
 void consumer(){
     int m;
 
-    printf("Consumer starting...\n");
+    klog("Consumer starting...\n");
     while (1) {
         m = displayOn ? get(&b0) : timedGet(&b0, FREEZE_FOR);
 
@@ -156,38 +145,36 @@ void consumer(){
                 displayOn = 1;
                 break;
             default:
-                printf("Wrong command!\n");
+                klog("Wrong command!\n");
                 break;
         }
     }
 }
 
-void countAndDisplay() {
-    int counter = 0;
-
-    displayNumber(counter);
-
-    while(1) {
-        if (displayOn) {
-            displayNumber(counter);
-        }
-        if (started)
-            counter = (counter + 1) % 1000;
-        if (reset) {
-            counter = 0;
-            reset = 0;
-        }
+/* periodic timer callback, run by the kernel every INTERVAL ticks */
+void countAndDisplay(void* arg) {
+    static int counter = 0;
 
-        sleep(INTERVAL);
+    if (displayOn) {
+        displayNumber(counter);
+    }
+    if (started)
+        counter = (counter + 1) % 1000;
+    if (reset) {
+        counter = 0;
+        reset = 0;
     }
 }
 
 int main() {
-    IOWR_ALTERA_AVALON_PIO_DATA(LED_COLOR_BASE, LED_COLOR_RESET_VALUE);
+    initDisplay();
+    initInput();
+    displaySet(DISPLAY_COLOR, LED_COLOR_RESET_VALUE);
     initBuffer(&b0);
     createProcess(producer, STACK_SIZE);
     createProcess(consumer, STACK_SIZE);
-    createProcess(countAndDisplay, STACK_SIZE);
+    displayNumber(0);
+    startTimer(createTimer(countAndDisplay, NULL, INTERVAL, 1));
 
     start();
     return 0;
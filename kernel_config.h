@@ -0,0 +1,181 @@
+#ifndef KERNEL_CONFIG_H_
+#define KERNEL_CONFIG_H_
+
+/*
+ * Configuration of the kernel image. Every table, stack and queue of the
+ * kernel is a static array sized from the values below, so the linker map
+ * shows exactly how much RAM the kernel needs.
+ */
+
+/************* Table sizes ************/
+#define MAX_PROC 10
+#define MAX_MONITORS 10
+#define NESTING_DEPTH 10 /* nested monitor calls per process */
+#define MAX_TIMERS 10
+#define MAX_TASKLETS 16 /* at most 32: one pending bit per tasklet */
+#define MAX_CHANNELS 8
+#define MAX_CHANNEL_DEPTH 16
+#define MAX_SEMAPHORES 10
+#define MAX_MUTEXES 10
+#define MAX_IDLE_HOOKS 4
+#define MAX_POOLS 8
+
+/* Processes waiting for an interrupt at the same time: the clock process
+ * plus every application process */
+#define MAX_WAITERS (MAX_PROC + 1)
+
+/************* Scheduling ************/
+#define INTERRUPT_COUNT 2 /* 0: timer, 1: buttons */
+#define TIME_SLICE 20 /* clock ticks */
+#define TICKS_PER_SECOND 1000 /* the timer interrupts every millisecond */
+
+/* Levels of MLFQ_SCHEDULING; the quantum doubles at each level down */
+#define MLFQ_LEVELS 3
+#define MLFQ_QUANTUM 5 /* clock ticks at level 0 */
+#define MLFQ_AGING_TICKS 1000 /* period at which all go back to level 0 */
+
+/************* Logging ************/
+#define LOG_BUFFER_SIZE 1024 /* a power of two */
+#define LOG_LINE_SIZE 96 /* longer messages are truncated */
+#define LOG_TICK_BYTES 16 /* characters sent by each clock tick */
+
+/************* Display ************/
+#define DISPLAY_REFRESH_TICKS 20 /* period of the display driver */
+#define DISPLAY_BLINK_TICKS 200 /* half period of a blink */
+
+/************* Input ************/
+#define INPUT_DEBOUNCE_TICKS 10 /* samples a key must stay stable */
+#define INPUT_QUEUE_SIZE 32 /* events kept until read */
+#define INPUT_BUTTONS 4 /* width of the buttons PIO */
+#define INPUT_SWITCH_BITS 8 /* width of the SWITCH_0 and SWITCH_1 PIOs */
+#define INPUT_BUTTONS_ACTIVE_LOW 1 /* a pressed button reads 0 */
+
+/************* PC sampling ************/
+#define PROFILE_BUCKETS 256 /* distinct code ranges kept; a power of two */
+#define PROFILE_BUCKET_SHIFT 4 /* a range is 16 bytes of code */
+#define PROFILE_PERIOD_TICKS 1 /* clock ticks between samples */
+
+/************* Kernel dump ************/
+#define DUMP_POLL_TICKS 50 /* period of the check for a dump request */
+#define DUMP_STACK_SIZE STACK_SIZE
+
+/************* CPU load ************/
+/* seconds of load history kept for cpuLoad */
+#define LOAD_HISTORY 60
+
+/* a pass of the idle loop longer than this was interrupted, and is not
+ * counted as idle time */
+#define IDLE_LOOP_CYCLES 200
+
+/************* Stacks ************/
+#define STACK_SIZE 10000
+
+/* stack size of the idle, clock and tasklet processes */
+#define KERNEL_STACK_SIZE STACK_SIZE
+
+/*
+ * Processes started by start() on static stacks, after those created
+ * with createProcess. Each entry is TASK(function, stackSize), e.g.
+ *
+ *     #define KERNEL_TASKS(TASK) \
+ *         TASK(producer, STACK_SIZE) \
+ *         TASK(consumer, STACK_SIZE)
+ */
+#define KERNEL_TASKS(TASK)
+
+/************* Build options ************/
+
+/* Removes createProcess and createPool, the only kernel functions using
+ * the heap, so that any remaining use fails to link. */
+/* #define KERNEL_NO_HEAP */
+
+/* Records the longest window with interrupts masked (see interrupt.h). */
+/* #define PROFILE_MASKED */
+
+/* Counts the calls to each kernel primitive and their cost in cycles
+ * (see getCallProfile in kernel2.h). */
+/* #define PROFILE_CALLS */
+
+/* Samples the interrupted program counter on clock ticks (see profile.h). */
+/* #define PROFILE_PC */
+
+/* Makes the clock stop rotating the ready processes every TIME_SLICE
+ * ticks, so that they only switch when they block or yield; processes
+ * that call setPreemptible(1) are still rotated. */
+/* #define COOPERATIVE_SCHEDULING */
+
+/* Replaces the TIME_SLICE rotation by a multilevel feedback scheduler.
+ * Ready processes run in order of level, round robin within a level. A
+ * process that uses up its quantum moves down a level, and one that
+ * blocks before using up a quantum moves up a level, so that processes
+ * waiting for input run ahead of those computing. The clock preempts a
+ * process once a better level is ready, and moves every process back to
+ * level 0 every MLFQ_AGING_TICKS (see getLevelStats in kernel2.h). */
+/* #define MLFQ_SCHEDULING */
+
+/* Makes notify hand the monitor to the notified process as soon as the
+ * notifier leaves, ahead of processes already waiting to enter, and run
+ * it right away. */
+/* #define MONITOR_HANDOFF */
+
+/* Compiles checkKernel, which verifies the consistency of the kernel
+ * tables (see host/harness.c), and makes poolFree look for the block in
+ * the free list, to catch every double free. */
+/* #define KERNEL_CHECKS */
+
+/* Places the hot kernel paths in on-chip memory (see placement.h). */
+/* #define KERNEL_IN_ONCHIP */
+/* #define ONCHIP_KERNEL_STACKS */
+
+/************* Compile-time checks ************/
+#if MAX_TASKLETS > 32
+#error "MAX_TASKLETS cannot exceed the 32 bits of the pending mask"
+#endif
+
+#if NESTING_DEPTH > 255
+#error "NESTING_DEPTH must fit in the nesting counter"
+#endif
+
+#if LOAD_HISTORY < 1 || TICKS_PER_SECOND < 1
+#error "the load history needs at least one second of one tick"
+#endif
+
+#if MLFQ_LEVELS < 1 || MLFQ_QUANTUM < 1 || MLFQ_AGING_TICKS < 1 \
+    || (MLFQ_QUANTUM << (MLFQ_LEVELS - 1)) > 0xffff
+#error "invalid scheduling levels, or a quantum longer than 65535 ticks"
+#endif
+
+#if LOG_BUFFER_SIZE & (LOG_BUFFER_SIZE - 1)
+#error "LOG_BUFFER_SIZE must be a power of two"
+#endif
+
+#if PROFILE_BUCKETS & (PROFILE_BUCKETS - 1) || PROFILE_PERIOD_TICKS < 1
+#error "PROFILE_BUCKETS must be a power of two and PROFILE_PERIOD_TICKS positive"
+#endif
+
+#if MAX_PROC < 1 || MAX_MONITORS < 1 || MAX_CHANNEL_DEPTH < 1
+#error "kernel tables cannot be empty"
+#endif
+
+#if MAX_WAITERS < MAX_PROC + 1
+#error "MAX_WAITERS must allow every process and the clock to wait for interrupts"
+#endif
+
+#if INPUT_DEBOUNCE_TICKS < 1 || INPUT_DEBOUNCE_TICKS > 255 || INPUT_QUEUE_SIZE < 1
+#error "invalid input debouncing or queue size"
+#endif
+
+#if INTERRUPT_COUNT != 2
+#error "interrupt.c only handles the timer and the buttons"
+#endif
+
+/* _createStack stores a 100-byte frame and the stack pointer below it */
+#if STACK_SIZE < 512 || KERNEL_STACK_SIZE < 512
+#error "stacks must hold at least a context switch frame and a few calls"
+#endif
+
+#if STACK_SIZE % 4 != 0 || KERNEL_STACK_SIZE % 4 != 0
+#error "stack sizes must be a multiple of the word size"
+#endif
+
+#endif /*KERNEL_CONFIG_H_*/
@@ -0,0 +1,88 @@
+#include <stdio.h>
+#include <stdarg.h>
+#include <system.h>
+#include <altera_avalon_jtag_uart_regs.h>
+
+#include "kernel_config.h"
+#include "interrupt.h"
+#include "log.h"
+
+#define LOG_MASK (LOG_BUFFER_SIZE - 1)
+
+/* Characters waiting to be sent; head and tail run freely and are masked
+ * on access, so head - tail is the number of characters in the ring */
+static char logRing[LOG_BUFFER_SIZE];
+static unsigned int logHead = 0;
+static unsigned int logTail = 0;
+
+static unsigned int dropped = 0;
+
+void klog(const char* format, ...)
+{
+    char line[LOG_LINE_SIZE];
+    va_list args;
+    unsigned int length, i;
+    int written;
+
+    /* format outside of the critical section, on the caller's stack */
+    va_start(args, format);
+    written = vsnprintf(line, sizeof(line), format, args);
+    va_end(args);
+
+    if(written < 0){
+        return;
+    }
+    /* vsnprintf returns the length the line would have had */
+    length = (unsigned int) written;
+    if(length >= sizeof(line)){
+        length = sizeof(line) - 1;
+    }
+
+    irqState state = kernelLock();
+
+    if(LOG_BUFFER_SIZE - (logHead - logTail) < length){
+        dropped++;
+    }
+    else{
+        for(i = 0; i < length; i++){
+            logRing[logHead++ & LOG_MASK] = line[i];
+        }
+    }
+
+    kernelUnlock(state);
+}
+
+void logFlush()
+{
+    logFlushBytes(LOG_BUFFER_SIZE);
+}
+
+void logFlushBytes(unsigned int max)
+{
+    unsigned int space;
+
+    if(logHead == logTail){
+        return;
+    }
+
+    irqState state = kernelLock();
+
+    space = (IORD_ALTERA_AVALON_JTAG_UART_CONTROL(JTAG_UART_0_BASE)
+             & ALTERA_AVALON_JTAG_UART_CONTROL_WSPACE_MSK)
+            >> ALTERA_AVALON_JTAG_UART_CONTROL_WSPACE_OFST;
+    if(space > max){
+        space = max;
+    }
+
+    while(space > 0 && logTail != logHead){
+        IOWR_ALTERA_AVALON_JTAG_UART_DATA(JTAG_UART_0_BASE, logRing[logTail++ & LOG_MASK]);
+        space--;
+    }
+
+    kernelUnlock(state);
+}
+
+unsigned int logDropped()
+{
+    return dropped;
+}
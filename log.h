@@ -0,0 +1,21 @@
+#ifndef LOG_H_
+#define LOG_H_
+
+/* Function that formats a message like printf into the log ring buffer.
+ * It never waits for the JTAG UART: when the ring is full the message is
+ * dropped and counted instead. It may be called from interrupt handlers. */
+void klog(const char* format, ...);
+
+/* Function that copies as much of the ring as fits into the JTAG UART
+ * transmit FIFO, without waiting. The idle process calls it. */
+void logFlush();
+
+/* Function that copies at most max characters, as logFlush. The clock
+ * calls it every tick with LOG_TICK_BYTES, so that the log drains even
+ * when the idle process never runs. */
+void logFlushBytes(unsigned int max);
+
+/* Function that returns the number of messages dropped so far. */
+unsigned int logDropped();
+
+#endif /*LOG_H_*/
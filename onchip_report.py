@@ -0,0 +1,78 @@
+#!/usr/bin/env python3
+"""Report what the linker placed in the on-chip memory.
+
+Usage: onchip_report.py <elf file>
+
+Lists every symbol that landed in onchip_mem (0x2000000-0x2004000 in
+qsys_top_new.sopcinfo), the space left, and the kernel hot paths that
+were left in SDRAM. Set NM to use another nm than nios2-elf-nm.
+"""
+
+import os
+import subprocess
+import sys
+
+ONCHIP_START = 0x2000000
+ONCHIP_END = 0x2004000
+
+# symbols placed by placement.h when compiling with -DKERNEL_IN_ONCHIP
+HOT_SYMBOLS = [
+    "_transfer", "kernelLock", "kernelUnlock", "transfer", "iotransfer",
+    "running", "nextP", "readyList", "sleepingList", "processLinks",
+    "processHandles", "monitors",
+    "addLast", "addFirst", "removeHead", "removeElement", "head", "isEmpty",
+    "spliceLast", "checkAndTransfer",
+    "clockHandler", "interruptVector", "listElemMemory", "removeHeadI",
+    "insertTail", "handle_timer_interrupts", "handle_button_interrupts",
+]
+
+
+def read_symbols(elf):
+    nm = os.environ.get("NM", "nios2-elf-nm")
+    out = subprocess.check_output([nm, "-S", "-n", elf], universal_newlines=True)
+    symbols = []
+    for line in out.splitlines():
+        fields = line.split()
+        if len(fields) == 4:
+            address, size, kind, name = fields
+            symbols.append((int(address, 16), int(size, 16), kind, name))
+        elif len(fields) == 3:
+            address, kind, name = fields
+            symbols.append((int(address, 16), 0, kind, name))
+    return symbols
+
+
+def main():
+    if len(sys.argv) != 2:
+        sys.stderr.write(__doc__)
+        return 2
+
+    symbols = read_symbols(sys.argv[1])
+    onchip = [s for s in symbols if ONCHIP_START <= s[0] < ONCHIP_END and s[1] > 0]
+    placed = {s[3] for s in onchip}
+
+    print("onchip_mem 0x%08x-0x%08x" % (ONCHIP_START, ONCHIP_END))
+    print("%-10s %6s  %-4s %s" % ("address", "size", "kind", "symbol"))
+    code = data = 0
+    for address, size, kind, name in onchip:
+        print("0x%08x %6d  %-4s %s" % (address, size, kind, name))
+        if kind in "Tt":
+            code += size
+        else:
+            data += size
+
+    used = max([a + s for a, s, _, _ in onchip] or [ONCHIP_START]) - ONCHIP_START
+    print()
+    print("code %d bytes, data %d bytes, %d of %d bytes used, %d free"
+          % (code, data, used, ONCHIP_END - ONCHIP_START,
+             ONCHIP_END - ONCHIP_START - used))
+
+    defined = {s[3] for s in symbols}
+    missing = [name for name in HOT_SYMBOLS if name in defined and name not in placed]
+    if missing:
+        print("not in onchip_mem: " + ", ".join(missing))
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
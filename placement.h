@@ -0,0 +1,37 @@
+#ifndef PLACEMENT_H_
+#define PLACEMENT_H_
+
+/*
+ * Placement of the kernel in the 16 KB on-chip memory (onchip_mem,
+ * 0x2000000-0x2004000 in qsys_top_new.sopcinfo).
+ *
+ * Compiling with -DKERNEL_IN_ONCHIP (and assembling asm.s with
+ * --defsym KERNEL_IN_ONCHIP=1) moves the scheduler's hot data and the
+ * context switch, interrupt and clock paths out of SDRAM. The HAL linker
+ * script gathers the input sections named ".onchip_mem" and "onchip_mem.*"
+ * into the onchip_mem region; code and data need different section names
+ * because gcc refuses to mix them in one section.
+ *
+ * Adding -DONCHIP_KERNEL_STACKS also moves the stacks of the kernel
+ * processes (idle, clk and tasklet). Three default stacks do not fit in
+ * 16 KB, so KERNEL_STACK_SIZE must be lowered along with it.
+ *
+ * onchip_report.py lists what the linker actually placed there.
+ */
+#include "kernel_config.h"
+
+#ifdef KERNEL_IN_ONCHIP
+#define ONCHIP_CODE __attribute__((section("onchip_mem.text")))
+#define ONCHIP_DATA __attribute__((section(".onchip_mem")))
+#else
+#define ONCHIP_CODE
+#define ONCHIP_DATA
+#endif
+
+#ifdef ONCHIP_KERNEL_STACKS
+#define ONCHIP_STACK ONCHIP_DATA
+#else
+#define ONCHIP_STACK
+#endif
+
+#endif /*PLACEMENT_H_*/
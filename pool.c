@@ -0,0 +1,162 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include "kernel_config.h"
+#include "interrupt.h"
+#include "pool.h"
+
+#define ERRA(text, ...) fprintf(stderr, "Error: " text "\n", __VA_ARGS__)
+
+typedef struct {
+    char* memory;
+    void* freeList; /* free blocks, linked through their first word */
+    int blockSize;
+    int count;
+    int used;
+    int highWater;
+    int failures;
+} PoolDescriptor;
+
+/* List of pool descriptors */
+static PoolDescriptor pools[MAX_POOLS];
+static int nextPoolId = 0;
+
+static void checkPool(int poolID) {
+    if (poolID >= nextPoolId || poolID < 0) {
+        ERRA("Pool %d does not exist.", poolID);
+        exit(1);
+    }
+}
+
+/* checks if block is on the free list of pool; walks the whole list, so
+ * only with KERNEL_CHECKS */
+#ifdef KERNEL_CHECKS
+static int isFree(PoolDescriptor* pool, void* block) {
+    void** free;
+
+    for (free = pool->freeList; free != NULL; free = *free) {
+        if (free == block) {
+            return 1;
+        }
+    }
+    return 0;
+}
+#else
+#define isFree(pool, block) 0
+#endif
+
+int createPoolFrom(void* memory, int blockSize, int count) {
+    int i;
+    PoolDescriptor* pool;
+
+    if (nextPoolId == MAX_POOLS) {
+        ERRA("Maximum number of pools (%d) reached!", MAX_POOLS);
+        exit(1);
+    }
+    if (memory == NULL || blockSize <= 0 || count <= 0) {
+        ERRA("Invalid pool of %d blocks of %d bytes.", count, blockSize);
+        exit(1);
+    }
+
+    pool = &pools[nextPoolId];
+    pool->memory = memory;
+    pool->blockSize = POOL_BLOCK_SIZE(blockSize);
+    pool->count = count;
+    pool->used = 0;
+    pool->highWater = 0;
+    pool->failures = 0;
+
+    /* thread every block onto the free list, lowest address first */
+    pool->freeList = NULL;
+    for (i = count - 1; i >= 0; i--) {
+        void** block = (void**) (pool->memory + i * pool->blockSize);
+        *block = pool->freeList;
+        pool->freeList = block;
+    }
+
+    return nextPoolId++;
+}
+
+#ifndef KERNEL_NO_HEAP
+int createPool(int blockSize, int count) {
+    void* memory = NULL;
+
+    if (blockSize > 0 && count > 0) {
+        memory = malloc(count * POOL_BLOCK_SIZE(blockSize));
+        if (memory == NULL) {
+            ERRA("Could not allocate a pool of %d blocks of %d bytes.", count, blockSize);
+            exit(1);
+        }
+    }
+    return createPoolFrom(memory, blockSize, count);
+}
+#endif
+
+void* poolAlloc(int poolID) {
+    void** block;
+    PoolDescriptor* pool;
+    irqState state;
+
+    checkPool(poolID);
+    pool = &pools[poolID];
+
+    state = kernelLock();
+
+    block = pool->freeList;
+    if (block != NULL) {
+        pool->freeList = *block;
+        if (++pool->used > pool->highWater) {
+            pool->highWater = pool->used;
+        }
+    }
+    else {
+        pool->failures++;
+    }
+
+    kernelUnlock(state);
+    return block;
+}
+
+void poolFree(int poolID, void* block) {
+    PoolDescriptor* pool;
+    irqState state;
+    char* p = block;
+
+    checkPool(poolID);
+    pool = &pools[poolID];
+
+    if (p < pool->memory || p >= pool->memory + pool->count * pool->blockSize
+        || (p - pool->memory) % pool->blockSize != 0) {
+        ERRA("Block %p does not belong to pool %d.", block, poolID);
+        exit(1);
+    }
+
+    state = kernelLock();
+
+    /* a double free would link the block twice */
+    if (pool->used == 0 || isFree(pool, block)) {
+        ERRA("Block %p of pool %d is freed twice.", block, poolID);
+        exit(1);
+    }
+
+    *(void**) block = pool->freeList;
+    pool->freeList = block;
+    pool->used--;
+
+    kernelUnlock(state);
+}
+
+void getPoolStats(int poolID, PoolStats* stats) {
+    irqState state;
+
+    checkPool(poolID);
+
+    state = kernelLock();
+
+    stats->blockSize = pools[poolID].blockSize;
+    stats->count = pools[poolID].count;
+    stats->used = pools[poolID].used;
+    stats->highWater = pools[poolID].highWater;
+    stats->failures = pools[poolID].failures;
+
+    kernelUnlock(state);
+}
@@ -0,0 +1,38 @@
+#ifndef POOL_H_
+#define POOL_H_
+
+/* Size actually reserved for a block of size bytes: blocks hold the free
+ * list link while they are free, so they are rounded up to a pointer. */
+#define POOL_BLOCK_SIZE(size) (((size) + sizeof(void*) - 1) & ~(sizeof(void*) - 1))
+
+typedef struct {
+    int blockSize;
+    int count;
+    int used;
+    int highWater; /* largest number of blocks ever used at once */
+    int failures;  /* poolAlloc calls that found the pool empty */
+} PoolStats;
+
+/* Function that creates a pool of count blocks of blockSize bytes. The pool
+ * memory comes from the heap, so pools must be created before start(). */
+int createPool(int blockSize, int count);
+
+/* Function that creates a pool on memory provided by the caller, which must
+ * hold count * POOL_BLOCK_SIZE(blockSize) bytes. */
+int createPoolFrom(void* memory, int blockSize, int count);
+
+/* Declares static memory for a pool created with createPoolFrom. */
+#define POOL_MEMORY(name, blockSize, count) \
+    static void* name[(count) * POOL_BLOCK_SIZE(blockSize) / sizeof(void*)]
+
+/* Function that returns a free block, or NULL if the pool is exhausted.
+ * It runs in constant time and may be called from interrupt handlers. */
+void* poolAlloc(int poolID);
+
+/* Function that gives a block back to the pool it was allocated from. */
+void poolFree(int poolID, void* block);
+
+/* Function that copies the usage statistics of a pool into stats. */
+void getPoolStats(int poolID, PoolStats* stats);
+
+#endif /*POOL_H_*/
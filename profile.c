@@ -0,0 +1,92 @@
+#include <stdio.h>
+#include <string.h>
+
+#include "kernel_config.h"
+#include "interrupt.h"
+#include "kernel2.h"
+#include "profile.h"
+
+/* A range of code and its samples; count 0 marks a free bucket */
+typedef struct {
+    unsigned int range; /* pc >> PROFILE_BUCKET_SHIFT */
+    unsigned int count;
+} ProfileBucket;
+
+/* Open addressing table of the sampled ranges */
+static ProfileBucket buckets[PROFILE_BUCKETS];
+
+/* Samples per process; the last entry is for the kernel processes */
+static unsigned int processSamples[MAX_PROC + 1];
+
+static unsigned int samples = 0;
+static unsigned int lost = 0; /* samples of new ranges once the table is full */
+static volatile int profiling = 0;
+
+void profileSample(unsigned int pc)
+{
+    static int countdown = PROFILE_PERIOD_TICKS;
+    unsigned int range = pc >> PROFILE_BUCKET_SHIFT;
+    unsigned int i, slot;
+    int pid;
+
+    if(!profiling || --countdown > 0){
+        return;
+    }
+    countdown = PROFILE_PERIOD_TICKS;
+
+    samples++;
+    pid = getRunningProcess();
+    processSamples[pid < 0 ? MAX_PROC : pid]++;
+
+    /* multiplicative hash, then linear probing */
+    slot = (range * 2654435761u) >> 8;
+    for(i = 0; i < PROFILE_BUCKETS; i++){
+        ProfileBucket* bucket = &buckets[(slot + i) & (PROFILE_BUCKETS - 1)];
+        if(bucket->count == 0){
+            bucket->range = range;
+        }
+        if(bucket->range == range){
+            bucket->count++;
+            return;
+        }
+    }
+    lost++;
+}
+
+void profileStart()
+{
+    profiling = 1;
+}
+
+void profileStop()
+{
+    profiling = 0;
+}
+
+void profileReset()
+{
+    irqState state = kernelLock();
+    memset(buckets, 0, sizeof(buckets));
+    memset(processSamples, 0, sizeof(processSamples));
+    samples = 0;
+    lost = 0;
+    kernelUnlock(state);
+}
+
+void profileDump()
+{
+    int i;
+
+    printf("profile begin samples=%u lost=%u shift=%d\n", samples, lost, PROFILE_BUCKET_SHIFT);
+    for(i = 0; i <= MAX_PROC; i++){
+        if(processSamples[i] != 0){
+            printf("process %d %u\n", i == MAX_PROC ? -1 : i, processSamples[i]);
+        }
+    }
+    for(i = 0; i < PROFILE_BUCKETS; i++){
+        if(buckets[i].count != 0){
+            printf("bucket 0x%08x %u\n", buckets[i].range << PROFILE_BUCKET_SHIFT, buckets[i].count);
+        }
+    }
+    printf("profile end\n");
+}
@@ -0,0 +1,28 @@
+#ifndef PROFILE_H_
+#define PROFILE_H_
+
+/* Compiling with -DPROFILE_PC makes the timer interrupt sample the
+ * interrupted program counter and process every PROFILE_PERIOD_TICKS
+ * ticks, while profiling is started. Samples are counted per range of
+ * 2^PROFILE_BUCKET_SHIFT bytes of code and per process; profile_report.py
+ * resolves the ranges dumped by profileDump to functions. Code that runs
+ * with interrupts masked is never sampled, and neither are the clock and
+ * tasklet processes. */
+
+/* Function that starts counting samples. */
+void profileStart();
+
+/* Function that stops counting samples; the counts are kept. */
+void profileStop();
+
+/* Function that clears all counts. */
+void profileReset();
+
+/* Function that writes the counts to the JTAG UART. It blocks until they
+ * are written, so call it from a process, with profiling stopped. */
+void profileDump();
+
+/* Function that records one sample; called by the timer interrupt. */
+void profileSample(unsigned int pc);
+
+#endif /*PROFILE_H_*/
@@ -0,0 +1,92 @@
+#!/usr/bin/env python3
+"""Resolve a PC-sampling profile against the symbols of the program.
+
+Usage: profile_report.py <elf file> [dump file]
+
+Reads the output of profileDump (from the dump file, or standard input,
+e.g. a saved nios2-terminal session) and prints the samples per process
+and per function, most sampled first. Only the last complete dump is
+used. A code range is charged to the function its first byte belongs to,
+so with a large PROFILE_BUCKET_SHIFT small functions may be merged into
+their neighbours. Set NM to use another nm than nios2-elf-nm.
+"""
+
+import bisect
+import os
+import subprocess
+import sys
+
+
+def read_functions(elf):
+    nm = os.environ.get("NM", "nios2-elf-nm")
+    out = subprocess.check_output([nm, "-n", elf], universal_newlines=True)
+    functions = []
+    for line in out.splitlines():
+        fields = line.split()
+        if len(fields) == 3 and fields[1] in "TtWw":
+            functions.append((int(fields[0], 16), fields[2]))
+    return functions
+
+
+def read_dump(lines):
+    dump = None
+    complete = None
+    for line in lines:
+        fields = line.split()
+        if not fields:
+            continue
+        if fields[0] == "profile" and len(fields) > 1 and fields[1] == "begin":
+            header = dict(f.split("=") for f in fields[2:])
+            dump = {"samples": int(header["samples"]), "lost": int(header["lost"]),
+                    "processes": {}, "buckets": []}
+        elif dump is None:
+            continue
+        elif fields[0] == "process" and len(fields) == 3:
+            dump["processes"][int(fields[1])] = int(fields[2])
+        elif fields[0] == "bucket" and len(fields) == 3:
+            dump["buckets"].append((int(fields[1], 16), int(fields[2])))
+        elif fields[0] == "profile" and fields[1:] == ["end"]:
+            complete = dump
+            dump = None
+    return complete
+
+
+def main():
+    if len(sys.argv) not in (2, 3):
+        sys.stderr.write(__doc__)
+        return 2
+
+    functions = read_functions(sys.argv[1])
+    addresses = [a for a, _ in functions]
+    if len(sys.argv) == 3:
+        with open(sys.argv[2]) as f:
+            dump = read_dump(f)
+    else:
+        dump = read_dump(sys.stdin)
+    if dump is None:
+        sys.stderr.write("no complete profile dump found\n")
+        return 1
+
+    total = dump["samples"] or 1
+    print("%d samples, %d in ranges that did not fit" % (dump["samples"], dump["lost"]))
+    print()
+    print("%-8s %8s %6s" % ("process", "samples", "%"))
+    for pid, count in sorted(dump["processes"].items(), key=lambda p: -p[1]):
+        name = "kernel" if pid < 0 else str(pid)
+        print("%-8s %8d %6.1f" % (name, count, 100.0 * count / total))
+
+    counts = {}
+    for address, count in dump["buckets"]:
+        i = bisect.bisect_right(addresses, address) - 1
+        name = functions[i][1] if i >= 0 else "0x%08x" % address
+        counts[name] = counts.get(name, 0) + count
+
+    print()
+    print("%8s %6s  %s" % ("samples", "%", "function"))
+    for name, count in sorted(counts.items(), key=lambda c: -c[1]):
+        print("%8d %6.1f  %s" % (count, 100.0 * count / total, name))
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
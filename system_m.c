@@ -1,45 +1,55 @@
-#include <stdio.h>
-#include <stdlib.h>
-#include "system_m.h"
-#include "assembly.h"
-#include "interrupt.h"
-
-
-Process running = NULL;  // pointer to the current process.
-Process nextP = NULL;  // variable used internally to implement transfer and iotransfer procedures
-
-Process newProcess(void (*f), unsigned int* stack, int stackSize){
-    
-    unsigned int* newPC = f;
-    int size = stackSize - 4;
-    
-    Process process = _createStack(stack,newPC,size);
-    return process;
-}
-
-/**
- * Called mainly from interrupt routine.
- * (Except for the first call)
- */
-void transfer(Process p){
-    
-    if(running == NULL){
-        running = malloc(sizeof(Process));
-    }
-    nextP = p ;
-    _transfer();
-   
-}
-
-/**
- * Called from kernel thread.
- */
-void iotransfer(Process p, int interruptV){
-    
-    insertTail(interruptV, running);
-    nextP = p;
-    _transfer();
-   
-}
-    
-    
+#include <stdio.h>
+#include <stdlib.h>
+#include "system_m.h"
+#include "assembly.h"
+#include "interrupt.h"
+#include "placement.h"
+
+
+Process running ONCHIP_DATA = NULL;  // pointer to the current process.
+Process nextP ONCHIP_DATA = NULL;  // variable used internally to implement transfer and iotransfer procedures
+
+static unsigned int* bootSP;  // saved sp of the code that performs the first transfer
+static unsigned int switches ONCHIP_DATA = 0;  // number of transfers and iotransfers
+
+Process newProcess(void (*f), unsigned int* stack, int stackSize){
+    
+    unsigned int* newPC = f;
+    int size = stackSize - 4;
+    
+    Process process = _createStack(stack,newPC,size);
+    return process;
+}
+
+/**
+ * Called mainly from interrupt routine.
+ * (Except for the first call)
+ */
+ONCHIP_CODE void transfer(Process p){
+    
+    if(running == NULL){
+        running = (Process) &bootSP;
+    }
+    nextP = p ;
+    switches++;
+    _transfer();
+   
+}
+
+/**
+ * Called from kernel thread.
+ */
+ONCHIP_CODE void iotransfer(Process p, int interruptV){
+    
+    insertTail(interruptV, running);
+    nextP = p;
+    switches++;
+    _transfer();
+   
+}
+
+unsigned int switchCount(){
+    return switches;
+}
+    
+    
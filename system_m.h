@@ -1,39 +1,52 @@
-#ifndef SYSTEM_M_H_
-#define SYSTEM_M_H_
-
-typedef unsigned int *Process;
-
-
-/* 
-    newProcess is a procedure that creates a new process. Parameter f denotes the function that constitutes 
-    the code of process, stack and stackSize define the process stack. Before newProcess is invoked, it is 
-    necessary to allocate space (using malloc) for stack. 
-     
- */ 
-
-
-Process newProcess(void (*f), unsigned int* stack, int stackSize);
-
-/*
-   This procedure suspends currently running process and transfers control to process p. 
-    
-*/
-void transfer(Process p);
-
-
-/*
-    This procedure registers that active process waits on interrupt interruptV, suspends active process and
-    transfers control to process p.
-  
- */
-void iotransfer(Process p, int interruptV);
-
-
-
-#endif /*SYSTEM_M_H_*/
-
-
-
-
-
-
+#ifndef SYSTEM_M_H_
+#define SYSTEM_M_H_
+
+#include "placement.h"
+
+typedef unsigned int *Process;
+
+/* Process being run, and the one transfer switches to. They live in
+ * on-chip memory with KERNEL_IN_ONCHIP; declaring the section keeps gcc
+ * from reaching them through gp as small data. */
+extern Process running ONCHIP_DATA;
+extern Process nextP ONCHIP_DATA;
+
+
+/* 
+    newProcess is a procedure that creates a new process. Parameter f denotes the function that constitutes 
+    the code of process, stack and stackSize define the process stack. Before newProcess is invoked, it is 
+    necessary to allocate space (using malloc) for stack. 
+     
+ */ 
+
+
+Process newProcess(void (*f), unsigned int* stack, int stackSize);
+
+/*
+   This procedure suspends currently running process and transfers control to process p. 
+    
+*/
+void transfer(Process p);
+
+
+/*
+    This procedure registers that active process waits on interrupt interruptV, suspends active process and
+    transfers control to process p.
+  
+ */
+void iotransfer(Process p, int interruptV);
+
+/*
+    This function returns the number of transfers and iotransfers performed so far.
+ */
+unsigned int switchCount();
+
+
+
+#endif /*SYSTEM_M_H_*/
+
+
+
+
+
+